@@ -0,0 +1,62 @@
+#include "bench.h"
+#include "core/arena.h"
+#include "core/memory.h"
+#include "platform/vmem.h"
+
+#include <string.h>
+
+// Fills a fresh 64 MiB arena over FRAMES simulated frames, as a level load
+// would, and reports the page faults and frame times each backing takes.
+
+#define ARENA_SIZE (64ull << 20)
+#define FRAMES 60
+#define FRAME_BYTES (1ull << 20)
+
+static void run(const char *name, uint32_t flags) {
+    uint64_t minor0, major0, minor1, major1, minor2, major2;
+    vmem_fault_count(&minor0, &major0);
+
+    double t0 = get_abs_time();
+    arena_alloc_t arena;
+    if (!arena_create_ex(ARENA_SIZE, flags, &arena)) {
+        printf("%-18s unavailable\n", name);
+        return;
+    }
+    double create = get_abs_time() - t0;
+    vmem_fault_count(&minor1, &major1);
+
+    double worst = 0.0, total = 0.0;
+    for (uint32_t i = 0; i < FRAMES; ++i) {
+        double start = get_abs_time();
+        void *block = arena_alloc(&arena, FRAME_BYTES);
+        if (block) memset(block, (int)i, FRAME_BYTES);
+        double frame = get_abs_time() - start;
+        worst = MAX(worst, frame);
+        total += frame;
+    }
+    vmem_fault_count(&minor2, &major2);
+
+    printf("%-18s %8.2f %8lu %8lu %8.3f %8.3f\n", name, create * 1e3,
+           (minor1 - minor0) + (major1 - major0),
+           (minor2 - minor1) + (major2 - major1), total / FRAMES * 1e3,
+           worst * 1e3);
+    arena_kill(&arena);
+}
+
+int main(void) {
+    if (!memory_system_init(1 << 20)) return 1;
+    printf("arena (%s), %u frames of %llu KiB\n", BENCH_MODE, FRAMES,
+           FRAME_BYTES >> 10);
+    printf("%-18s %8s %8s %8s %8s %8s\n", "backing", "create", "faults",
+           "faults", "frame", "worst");
+    printf("%-18s %8s %8s %8s %8s %8s\n", "", "ms", "create", "frames",
+           "ms", "ms");
+
+    run("virtual", ARENA_VIRTUAL);
+    run("prefault", ARENA_PREFAULT);
+    run("huge", ARENA_HUGE_PAGES);
+    run("huge+prefault", ARENA_HUGE_PAGES | ARENA_PREFAULT);
+
+    memory_system_kill();
+    return 0;
+}
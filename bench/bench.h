@@ -0,0 +1,31 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "core/define.h"
+#include "platform/window.h"
+
+#include <stdio.h>
+
+// Shared helpers for the bench/ programs. They link the engine without
+// main.c, so timing goes through the platform clock like the game loop.
+
+#if DEBUG
+#    define BENCH_MODE "debug"
+#else
+#    define BENCH_MODE "release"
+#endif
+
+static inline double bench_ns(double seconds, uint64_t ops) {
+    return seconds * 1e9 / (double)ops;
+}
+
+// xorshift64, cheap enough to stay out of the measurement
+static inline uint64_t bench_rand(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+#endif // BENCH_H
@@ -0,0 +1,118 @@
+#include "bench.h"
+#include "core/container/cmap.h"
+#include "core/container/map.h"
+#include "core/memory.h"
+#include "platform/thread.h"
+
+#include <unistd.h>
+
+// Registry-style traffic on the striped map at 1-32 threads, against the
+// same u64 table behind one mutex. Each op looks a random key up and
+// creates it when missing, so after warm-up nearly all of them are reads.
+
+#define MAX_THREADS 32
+#define KEYS 4096
+#define OPS 400000
+
+MAP_DEFINE_U64(one_table, void *)
+
+static cmap_t g_striped;
+static one_table_t g_single;
+static mutex_t g_single_lock;
+static bool g_use_single;
+static uint64_t g_created;
+
+static void *create(uint64_t key, void *user) {
+    (void)user;
+    ATOMIC_ADD(&g_created, 1);
+    return (void *)(uintptr_t)(key + 1);
+}
+
+static void *single_get_or_create(uint64_t key) {
+    mutex_lock(&g_single_lock);
+    void **value = one_table_get(&g_single, key);
+    if (!value) value = one_table_set(&g_single, key, create(key, NULL));
+    void *result = value ? *value : NULL;
+    mutex_unlock(&g_single_lock);
+    return result;
+}
+
+static void *worker(void *arg) {
+    uint64_t seed = (uint64_t)(uintptr_t)arg * 0x9E3779B97F4A7C15ull + 1;
+    uintptr_t sum = 0;
+    for (uint32_t i = 0; i < OPS; ++i) {
+        uint64_t key = bench_rand(&seed) % KEYS;
+        void *value;
+        if (g_use_single) {
+            value = single_get_or_create(key);
+        } else {
+            value = cmap_get(&g_striped, key);
+            if (!value) {
+                value = cmap_get_or_create(&g_striped, key, create, NULL,
+                                           NULL, NULL);
+            }
+        }
+        sum += (uintptr_t)value;
+    }
+    return (void *)sum;
+}
+
+static void run(arena_alloc_t *arena, uint32_t threads) {
+    pthread_t handles[MAX_THREADS];
+    cmap_create(&g_striped, arena, KEYS);
+    one_table_init(&g_single, KEYS);
+    mutex_create(&g_single_lock);
+    g_created = 0;
+
+    double start = get_abs_time();
+    for (uint32_t i = 0; i < threads; ++i) {
+        pthread_create(&handles[i], NULL, worker, (void *)(uintptr_t)(i + 1));
+    }
+    for (uint32_t i = 0; i < threads; ++i) {
+        pthread_join(handles[i], NULL);
+    }
+    double elapsed = get_abs_time() - start;
+
+    uint64_t acquired = 0, contended = 0;
+    uint32_t count = g_single.count;
+    if (!g_use_single) {
+        cmap_lock_stats(&g_striped, &acquired, &contended);
+        count = cmap_count(&g_striped);
+    }
+    printf("%8s %8u %10.1f %8lu %8u", g_use_single ? "single" : "striped",
+           threads, (double)threads * OPS / elapsed / 1e6, g_created, count);
+    // the single lock isn't instrumented
+    if (acquired) {
+        printf(" %9.2f%%\n", 100.0 * (double)contended / (double)acquired);
+    } else {
+        printf(" %10s\n", "-");
+    }
+
+    cmap_kill(&g_striped);
+    one_table_kill(&g_single);
+    mutex_kill(&g_single_lock);
+    arena_reset(arena);
+}
+
+int main(void) {
+    if (!memory_system_init(1 << 20) || !memory_heap_init(64 << 20)) {
+        return 1;
+    }
+    arena_alloc_t arena;
+    if (!arena_create(1 << 20, &arena, NULL)) return 1;
+
+    printf("cmap (%s), %ld cores, %u keys, %u ops per thread\n", BENCH_MODE,
+           sysconf(_SC_NPROCESSORS_ONLN), KEYS, OPS);
+    printf("%8s %8s %10s %8s %8s %10s\n", "lock", "threads", "Mops/s",
+           "created", "count", "contended");
+    for (int mode = 0; mode < 2; ++mode) {
+        g_use_single = mode == 1;
+        for (uint32_t n = 1; n <= MAX_THREADS; n *= 2) {
+            run(&arena, n);
+        }
+    }
+
+    arena_kill(&arena);
+    memory_system_kill();
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include "bench.h"
+#include "core/container/darray.h"
+#include "core/container/map.h"
+#include "core/container/sparse_set.h"
+#include "core/memory.h"
+
+// The typed containers at 1k-1M elements: darray push on heap and arena
+// backing, u64 map set/get/remove, sparse set insert/iterate/remove.
+
+DARRAY_DEFINE(u32_array, uint32_t)
+MAP_DEFINE_U64(u32_map, uint32_t)
+SPARSE_SET_DEFINE(f32_set, float)
+
+// spreads ids over the whole range instead of counting up
+#define SCATTER(i, n) ((uint32_t)(((uint64_t)(i) * 2654435761u) % (n)))
+
+static void bench_darray(arena_alloc_t *arena, uint32_t n) {
+    u32_array_t heap, arr;
+
+    double t0 = get_abs_time();
+    u32_array_init(&heap, NULL, 0);
+    for (uint32_t i = 0; i < n; ++i) {
+        u32_array_push(&heap, i);
+    }
+    double t1 = get_abs_time();
+    u32_array_init(&arr, arena, 0);
+    for (uint32_t i = 0; i < n; ++i) {
+        u32_array_push(&arr, i);
+    }
+    double t2 = get_abs_time();
+
+    printf("%8u darray   push heap %6.1f  push arena %6.1f\n", n,
+           bench_ns(t1 - t0, n), bench_ns(t2 - t1, n));
+    u32_array_kill(&heap);
+    u32_array_kill(&arr);
+}
+
+static void bench_map(uint32_t n) {
+    u32_map_t map;
+    u32_map_init(&map, 0);
+
+    double t0 = get_abs_time();
+    for (uint32_t i = 0; i < n; ++i) {
+        u32_map_set(&map, (uint64_t)i * 2654435761u, i);
+    }
+    double t1 = get_abs_time();
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        uint32_t *value = u32_map_get(&map, (uint64_t)i * 2654435761u);
+        if (value) sum += *value;
+    }
+    double t2 = get_abs_time();
+    for (uint32_t i = 0; i < n; ++i) {
+        u32_map_remove(&map, (uint64_t)i * 2654435761u);
+    }
+    double t3 = get_abs_time();
+
+    printf("%8u map      set %6.1f  get %6.1f  remove %6.1f  (%lu)\n", n,
+           bench_ns(t1 - t0, n), bench_ns(t2 - t1, n), bench_ns(t3 - t2, n),
+           sum);
+    u32_map_kill(&map);
+}
+
+static void bench_sparse(uint32_t n) {
+    f32_set_t set;
+    f32_set_init(&set, n);
+
+    double t0 = get_abs_time();
+    for (uint32_t i = 0; i < n; ++i) {
+        f32_set_insert(&set, SCATTER(i, n), 1.0f);
+    }
+    double t1 = get_abs_time();
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < set.count; ++i) {
+        sum += set.values[i];
+    }
+    double t2 = get_abs_time();
+    uint32_t count = set.count;
+    for (uint32_t i = 0; i < n; ++i) {
+        f32_set_remove(&set, SCATTER(i, n));
+    }
+    double t3 = get_abs_time();
+
+    printf("%8u sparse   insert %6.1f  iterate %6.2f  remove %6.1f  (%.0f)\n",
+           n, bench_ns(t1 - t0, n), bench_ns(t2 - t1, count),
+           bench_ns(t3 - t2, n), sum);
+    f32_set_kill(&set);
+}
+
+int main(void) {
+    if (!memory_system_init(1 << 20) || !memory_heap_init(512 << 20)) {
+        return 1;
+    }
+    arena_alloc_t arena;
+    if (!arena_create_ex(256ull << 20, ARENA_VIRTUAL, &arena)) return 1;
+
+    printf("containers (%s), ns per op\n", BENCH_MODE);
+    for (uint32_t n = 1000; n <= 1000000; n *= 10) {
+        bench_darray(&arena, n);
+        bench_map(n);
+        bench_sparse(n);
+        arena_reset(&arena);
+    }
+
+    arena_kill(&arena);
+    memory_system_kill();
+    return 0;
+}
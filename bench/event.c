@@ -0,0 +1,96 @@
+#include "bench.h"
+#include "core/event.h"
+#include "core/memory.h"
+#include "platform/thread.h"
+
+#include <string.h>
+#include <unistd.h>
+
+// event_post_async throughput with 1-8 producers while the main thread
+// drains through event_dispatch_all. Producers retry when the ring is full,
+// and every event carries its producer and sequence number so the handler
+// can check per-producer order.
+
+#define MAX_PRODUCERS 8
+#define PER_PRODUCER 200000
+
+static event_system_t *g_event;
+static uint64_t g_received;
+static uint32_t g_last_seq[MAX_PRODUCERS];
+static uint32_t g_out_of_order;
+static uint64_t g_full;
+
+static bool on_post(event_system_t *event, uint32_t type, event_t *ev,
+                    void *sender, void *recipient) {
+    (void)event;
+    (void)type;
+    (void)sender;
+    (void)recipient;
+    uint32_t producer = (uint32_t)ev->data.mouse_move.dx;
+    uint32_t seq = (uint32_t)ev->data.mouse_move.x;
+    if (seq != g_last_seq[producer] + 1) g_out_of_order++;
+    g_last_seq[producer] = seq;
+    g_received++;
+    return true;
+}
+
+static void *produce(void *arg) {
+    event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.data.mouse_move.dx = (int16_t)(uintptr_t)arg;
+    for (uint32_t i = 1; i <= PER_PRODUCER; ++i) {
+        ev.data.mouse_move.x = (int32_t)i;
+        while (!event_post_async(g_event, EVENT_MOUSE_MOVE, &ev, NULL)) {
+            ATOMIC_ADD(&g_full, 1);
+            thread_yield();
+        }
+    }
+    return NULL;
+}
+
+static void run(uint32_t producers) {
+    pthread_t handles[MAX_PRODUCERS];
+    uint64_t total = (uint64_t)producers * PER_PRODUCER;
+    g_received = 0;
+    g_out_of_order = 0;
+    g_full = 0;
+    memset(g_last_seq, 0, sizeof(g_last_seq));
+
+    double start = get_abs_time();
+    for (uint32_t i = 0; i < producers; ++i) {
+        pthread_create(&handles[i], NULL, produce, (void *)(uintptr_t)i);
+    }
+    while (g_received < total) {
+        event_dispatch_all(g_event);
+        thread_yield();
+    }
+    for (uint32_t i = 0; i < producers; ++i) {
+        pthread_join(handles[i], NULL);
+    }
+    double elapsed = get_abs_time() - start;
+
+    printf("%10u %10.1f %10lu %10u\n", producers,
+           (double)total / elapsed / 1e6, g_full, g_out_of_order);
+}
+
+int main(void) {
+    if (!memory_system_init(1 << 20)) return 1;
+    arena_alloc_t arena;
+    if (!arena_create(4 << 20, &arena, NULL)) return 1;
+    g_event = event_system_init(&arena);
+    if (!g_event) return 1;
+    event_reg(g_event, EVENT_MOUSE_MOVE, on_post, NULL);
+
+    printf("event (%s), %ld cores, %u events per producer\n", BENCH_MODE,
+           sysconf(_SC_NPROCESSORS_ONLN), PER_PRODUCER);
+    printf("%10s %10s %10s %10s\n", "producers", "Mevents/s", "ring full",
+           "reordered");
+    for (uint32_t n = 1; n <= MAX_PRODUCERS; n *= 2) {
+        run(n);
+    }
+
+    event_system_kill(g_event);
+    arena_kill(&arena);
+    memory_system_kill();
+    return 0;
+}
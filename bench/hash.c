@@ -0,0 +1,213 @@
+#include "bench.h"
+#include "core/container/hash.h"
+#include "core/memory.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// String map at 1k-1M keys against the table it replaced: fixed capacity,
+// a *31 hash, keys copied into the arena and strcmp on every probe. The
+// legacy copy below has its probe index fixed so both return the same
+// answers, and it is pre-sized to twice the key count since it can't grow.
+// The swiss table is sized for the keys up front too, "grown" is its insert
+// time when it starts from 16 slots instead. Keys go in and are looked up in
+// shuffled order: in key order the *31 hash of these keys walks the legacy
+// slots front to back. Each figure is the best of RUNS.
+
+#define KEY_LEN 24
+#define RUNS 3
+
+typedef struct {
+    const char *key;
+    uint64_t value;
+    bool used;
+} legacy_entry_t;
+
+typedef struct {
+    legacy_entry_t *entries;
+    uint32_t capacity;
+    arena_alloc_t *arena;
+} legacy_table_t;
+
+static uint32_t legacy_hash(const char *key) {
+    uint32_t hash = 0;
+    while (*key) {
+        hash = (hash * 31) + (uint8_t)*key++;
+    }
+    return hash;
+}
+
+static void legacy_set(legacy_table_t *t, const char *key, uint64_t value) {
+    uint32_t index = legacy_hash(key) % t->capacity;
+    for (uint32_t i = 0; i < t->capacity; ++i) {
+        legacy_entry_t *entry = &t->entries[(index + i) % t->capacity];
+        if (!entry->used) {
+            uint64_t key_len = strlen(key) + 1;
+            entry->key = memcpy(arena_alloc(t->arena, key_len), key, key_len);
+            entry->value = value;
+            entry->used = true;
+            return;
+        }
+        if (strcmp(entry->key, key) == 0) {
+            entry->value = value;
+            return;
+        }
+    }
+}
+
+static bool legacy_get(legacy_table_t *t, const char *key, uint64_t *out) {
+    uint32_t index = legacy_hash(key) % t->capacity;
+    for (uint32_t i = 0; i < t->capacity; ++i) {
+        legacy_entry_t *entry = &t->entries[(index + i) % t->capacity];
+        if (!entry->used) return false;
+        if (strcmp(entry->key, key) == 0) {
+            *out = entry->value;
+            return true;
+        }
+    }
+    return false;
+}
+
+typedef struct {
+    double insert, grown, lookup, miss, remove;
+    uint64_t sum;
+} result_t;
+
+static result_t run_legacy(arena_alloc_t *arena, char (*keys)[KEY_LEN],
+                           char (*misses)[KEY_LEN], const uint32_t *order,
+                           uint32_t n) {
+    result_t r = {0};
+    legacy_table_t t = {calloc(n * 2, sizeof(legacy_entry_t)), n * 2, arena};
+    if (!t.entries) return r;
+
+    double t0 = get_abs_time();
+    for (uint32_t i = 0; i < n; ++i) {
+        legacy_set(&t, keys[order[i]], order[i]);
+    }
+    double t1 = get_abs_time();
+    uint64_t value;
+    for (uint32_t i = 0; i < n; ++i) {
+        if (legacy_get(&t, keys[order[i]], &value)) r.sum += value;
+    }
+    double t2 = get_abs_time();
+    for (uint32_t i = 0; i < n; ++i) {
+        if (legacy_get(&t, misses[order[i]], &value)) r.sum++;
+    }
+    double t3 = get_abs_time();
+
+    r.insert = bench_ns(t1 - t0, n);
+    r.lookup = bench_ns(t2 - t1, n);
+    r.miss = bench_ns(t3 - t2, n);
+    free(t.entries);
+    return r;
+}
+
+static double run_grown(arena_alloc_t *arena, char (*keys)[KEY_LEN],
+                        const uint32_t *order, uint32_t n) {
+    hash_table_t *t = hash_create(arena, 16);
+    double t0 = get_abs_time();
+    for (uint32_t i = 0; i < n; ++i) {
+        hash_set(t, keys[order[i]], order[i]);
+    }
+    double t1 = get_abs_time();
+    hash_kill(t);
+    return bench_ns(t1 - t0, n);
+}
+
+static result_t run_swiss(arena_alloc_t *arena, char (*keys)[KEY_LEN],
+                          char (*misses)[KEY_LEN], const uint32_t *order,
+                          uint32_t n) {
+    result_t r = {0};
+    hash_table_t *t = hash_create(arena, n);
+
+    double t0 = get_abs_time();
+    for (uint32_t i = 0; i < n; ++i) {
+        hash_set(t, keys[order[i]], order[i]);
+    }
+    double t1 = get_abs_time();
+    uint64_t value;
+    for (uint32_t i = 0; i < n; ++i) {
+        if (hash_get(t, keys[order[i]], &value)) r.sum += value;
+    }
+    double t2 = get_abs_time();
+    for (uint32_t i = 0; i < n; ++i) {
+        if (hash_get(t, misses[order[i]], &value)) r.sum++;
+    }
+    double t3 = get_abs_time();
+    for (uint32_t i = 0; i < n; ++i) {
+        hash_remove(t, keys[order[i]]);
+    }
+    double t4 = get_abs_time();
+
+    r.insert = bench_ns(t1 - t0, n);
+    r.lookup = bench_ns(t2 - t1, n);
+    r.miss = bench_ns(t3 - t2, n);
+    r.remove = bench_ns(t4 - t3, n);
+    hash_kill(t);
+    return r;
+}
+
+static void keep_best(result_t *best, const result_t *run) {
+    best->insert = MIN(best->insert, run->insert);
+    best->grown = MIN(best->grown, run->grown);
+    best->lookup = MIN(best->lookup, run->lookup);
+    best->miss = MIN(best->miss, run->miss);
+    best->remove = MIN(best->remove, run->remove);
+    best->sum = run->sum;
+}
+
+int main(void) {
+    if (!memory_system_init(1 << 20) || !memory_heap_init(512 << 20)) {
+        return 1;
+    }
+    arena_alloc_t arena;
+    if (!arena_create_ex(1ull << 32, ARENA_VIRTUAL, &arena)) return 1;
+
+    printf("hash (%s), ns per op, legacy can't remove\n", BENCH_MODE);
+    printf("%8s %26s %17s %17s %8s\n", "keys", "insert", "lookup", "miss",
+           "remove");
+    printf("%8s %8s %8s %8s %8s %8s %8s %8s %8s\n", "", "swiss", "grown",
+           "legacy", "swiss", "legacy", "swiss", "legacy", "swiss");
+
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+    for (uint32_t n = 1000; n <= 1000000; n *= 10) {
+        char(*keys)[KEY_LEN] = malloc((uint64_t)n * KEY_LEN);
+        char(*misses)[KEY_LEN] = malloc((uint64_t)n * KEY_LEN);
+        uint32_t *order = malloc((uint64_t)n * sizeof(uint32_t));
+        if (!keys || !misses || !order) return 1;
+        for (uint32_t i = 0; i < n; ++i) {
+            snprintf(keys[i], KEY_LEN, "entity_%u_mesh", i);
+            snprintf(misses[i], KEY_LEN, "entity_%u_anim", i);
+            order[i] = i;
+        }
+        for (uint32_t i = n - 1; i > 0; --i) {
+            uint32_t j = (uint32_t)(bench_rand(&seed) % (i + 1));
+            uint32_t tmp = order[i];
+            order[i] = order[j];
+            order[j] = tmp;
+        }
+
+        result_t s = {1e9, 1e9, 1e9, 1e9, 1e9, 0};
+        result_t l = {1e9, 1e9, 1e9, 1e9, 1e9, 0};
+        for (uint32_t run = 0; run < RUNS; ++run) {
+            result_t r = run_swiss(&arena, keys, misses, order, n);
+            r.grown = run_grown(&arena, keys, order, n);
+            keep_best(&s, &r);
+            r = run_legacy(&arena, keys, misses, order, n);
+            keep_best(&l, &r);
+            arena_reset(&arena);
+        }
+        if (s.sum != l.sum) printf("results differ\n");
+        printf("%8u %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f\n", n,
+               s.insert, s.grown, l.insert, s.lookup, l.lookup, s.miss, l.miss,
+               s.remove);
+
+        free(keys);
+        free(misses);
+        free(order);
+    }
+
+    arena_kill(&arena);
+    memory_system_kill();
+    return 0;
+}
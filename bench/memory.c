@@ -0,0 +1,49 @@
+#include "bench.h"
+#include "core/memory.h"
+
+#include <stdlib.h>
+
+// WALLOC/WFREE throughput with 10k, 100k and 1M blocks live at once. Blocks
+// are freed in random order so the tracker can't lean on recency.
+
+#define BLOCK_SIZE 32
+
+int main(void) {
+    if (!memory_system_init(1 << 20) || !memory_heap_init(256 << 20)) {
+        return 1;
+    }
+    printf("memory (%s), ns per call\n", BENCH_MODE);
+    printf("%10s %8s %8s\n", "live", "alloc", "free");
+
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+    for (uint32_t n = 10000; n <= 1000000; n *= 10) {
+        void **blocks = malloc(n * sizeof(void *));
+        if (!blocks) return 1;
+
+        double t0 = get_abs_time();
+        for (uint32_t i = 0; i < n; ++i) {
+            blocks[i] = WALLOC(BLOCK_SIZE, MEM_GAME);
+        }
+        double t1 = get_abs_time();
+
+        for (uint32_t i = n - 1; i > 0; --i) {
+            uint32_t j = (uint32_t)(bench_rand(&seed) % (i + 1));
+            void *tmp = blocks[i];
+            blocks[i] = blocks[j];
+            blocks[j] = tmp;
+        }
+
+        double t2 = get_abs_time();
+        for (uint32_t i = 0; i < n; ++i) {
+            WFREE(blocks[i], BLOCK_SIZE, MEM_GAME);
+        }
+        double t3 = get_abs_time();
+
+        printf("%10u %8.1f %8.1f\n", n, bench_ns(t1 - t0, n),
+               bench_ns(t3 - t2, n));
+        free(blocks);
+    }
+
+    memory_system_kill();
+    return 0;
+}
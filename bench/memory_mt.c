@@ -0,0 +1,83 @@
+#include "bench.h"
+#include "core/memory.h"
+#include "platform/thread.h"
+
+#include <stdlib.h>
+
+// Mixed small alloc/free from several threads at once, WALLOC against the
+// system allocator. WALLOC hands out zeroed blocks, so calloc is the like for
+// like baseline. Each thread churns its own working set of SLOTS blocks.
+
+#define MAX_THREADS 8
+#define SLOTS 256
+#define OPS 400000
+#define MAX_SIZE 300
+
+typedef enum { USE_MALLOC, USE_CALLOC, USE_WALLOC } alloc_use_t;
+
+static alloc_use_t g_use;
+
+static void *churn(void *arg) {
+    uint64_t seed = (uint64_t)(uintptr_t)arg * 0x9E3779B97F4A7C15ull + 1;
+    void *blocks[SLOTS] = {0};
+    uint64_t sizes[SLOTS];
+
+    for (uint32_t i = 0; i < OPS; ++i) {
+        uint32_t k = (uint32_t)(bench_rand(&seed) % SLOTS);
+        if (blocks[k]) {
+            if (g_use == USE_WALLOC) WFREE(blocks[k], sizes[k], MEM_GAME);
+            else free(blocks[k]);
+            blocks[k] = NULL;
+        } else {
+            sizes[k] = bench_rand(&seed) % MAX_SIZE + 1;
+            switch (g_use) {
+                case USE_MALLOC: blocks[k] = malloc(sizes[k]); break;
+                case USE_CALLOC: blocks[k] = calloc(1, sizes[k]); break;
+                case USE_WALLOC: blocks[k] = WALLOC(sizes[k], MEM_GAME); break;
+            }
+        }
+    }
+    for (uint32_t k = 0; k < SLOTS; ++k) {
+        if (!blocks[k]) continue;
+        if (g_use == USE_WALLOC) WFREE(blocks[k], sizes[k], MEM_GAME);
+        else free(blocks[k]);
+    }
+
+    if (g_use == USE_WALLOC) memory_thread_flush();
+    return NULL;
+}
+
+static double run(uint32_t threads) {
+    pthread_t handles[MAX_THREADS];
+    double start = get_abs_time();
+    for (uint32_t i = 0; i < threads; ++i) {
+        pthread_create(&handles[i], NULL, churn, (void *)(uintptr_t)(i + 1));
+    }
+    for (uint32_t i = 0; i < threads; ++i) {
+        pthread_join(handles[i], NULL);
+    }
+    return get_abs_time() - start;
+}
+
+int main(void) {
+    if (!memory_system_init(1 << 20) || !memory_heap_init(64 << 20)) {
+        return 1;
+    }
+    printf("memory_mt (%s), %u ops per thread, ms\n", BENCH_MODE, OPS);
+    printf("%8s %8s %8s %8s\n", "threads", "malloc", "calloc", "WALLOC");
+
+    for (uint32_t n = 1; n <= MAX_THREADS; n *= 2) {
+        g_use = USE_MALLOC;
+        double sys = run(n);
+        g_use = USE_CALLOC;
+        double zeroed = run(n);
+        g_use = USE_WALLOC;
+        double engine = run(n);
+        printf("%8u %8.1f %8.1f %8.1f\n", n, sys * 1e3, zeroed * 1e3,
+               engine * 1e3);
+    }
+
+    printf("%s", mem_debug_stat());
+    memory_system_kill();
+    return 0;
+}
@@ -1,16 +1,22 @@
 #include "arena.h"
 #include "memory.h"
+#include "platform/vmem.h"
 
 #include <string.h>
 
 #define DEFAULT_ALIGNMENT 0x08
+#define COMMIT_GRANULE (64 * 1024)
+#define CHAIN_BLOCK_SIZE (64 * 1024)
+
+static INL uint64_t align_up(uint64_t value, uint64_t alignment) {
+    return (value + (alignment - 1)) & ~(alignment - 1);
+}
 
 bool arena_create(uint64_t total_size, arena_alloc_t *arena, void *memory) {
     if (!arena) return false;
 
+    memset(arena, 0, sizeof(*arena));
     arena->total_size = total_size;
-    arena->prev_offset = 0;
-    arena->curr_offset = 0;
     arena->own_memory = memory == NULL;
 
     if (memory) {
@@ -19,28 +25,150 @@ bool arena_create(uint64_t total_size, arena_alloc_t *arena, void *memory) {
         arena->memory = WALLOC(total_size, MEM_ARENA);
     }
 
-    if (!memory) return false;
+    if (!arena->memory) return false;
+    arena->committed = total_size;
+
+    return true;
+}
+
+static bool arena_commit(arena_alloc_t *arena, uint64_t end);
+
+bool arena_create_ex(uint64_t reserve_size, uint32_t flags,
+                     arena_alloc_t *arena) {
+    if (flags & (ARENA_HUGE_PAGES | ARENA_PREFAULT)) flags |= ARENA_VIRTUAL;
+
+    if (!(flags & ARENA_VIRTUAL)) {
+        if (!arena_create(reserve_size, arena, NULL)) return false;
+        arena->flags = flags;
+        return true;
+    }
+
+    if (!arena) return false;
+    memset(arena, 0, sizeof(*arena));
+
+    if (flags & ARENA_HUGE_PAGES) {
+        vmem_huge_t huge;
+        arena->total_size = align_up(reserve_size, vmem_huge_page_size());
+        arena->memory = vmem_reserve_huge(arena->total_size, &huge);
+        if (huge == VMEM_HUGE_NONE) {
+            LOG_WARN("huge pages unavailable, arena uses regular pages");
+        }
+    } else {
+        arena->total_size = align_up(reserve_size, vmem_page_size());
+        arena->memory = vmem_reserve(arena->total_size);
+    }
+    if (!arena->memory) return false;
+
+    arena->own_memory = true;
+    arena->flags = flags;
+
+    if (flags & ARENA_PREFAULT) {
+        uint64_t minor, major, minor_end, major_end;
+        vmem_fault_count(&minor, &major);
+        if (!arena_commit(arena, arena->total_size)) {
+            arena_kill(arena);
+            return false;
+        }
+        vmem_fault_count(&minor_end, &major_end);
+        LOG_DEBUG("arena prefaulted %lu bytes (%lu faults)", arena->total_size,
+                  (minor_end - minor) + (major_end - major));
+    }
 
     return true;
 }
 
+// free chained blocks newer than `keep`
+static void chain_free(arena_alloc_t *arena, arena_block_t *keep) {
+    arena_block_t *block = arena->chain;
+    while (block && block != keep) {
+        arena_block_t *prev = block->prev;
+        arena->chain_size -= block->size;
+        WFREE(block, sizeof(arena_block_t) + block->size, MEM_ARENA);
+        block = prev;
+    }
+    arena->chain = block;
+}
+
 void arena_kill(arena_alloc_t *arena) {
     if (!arena) return;
 
-    if (arena->memory) {
-        WFREE(arena->memory, arena->total_size, MEM_ARENA);
+    chain_free(arena, NULL);
+    if (arena->memory && arena->own_memory) {
+        if (arena->flags & ARENA_VIRTUAL) {
+            vmem_release(arena->memory, arena->total_size);
+        } else {
+            WFREE(arena->memory, arena->total_size, MEM_ARENA);
+        }
     }
     memset(arena, 0, sizeof(*arena));
 }
 
+static bool arena_commit(arena_alloc_t *arena, uint64_t end) {
+    if (end <= arena->committed) return true;
+
+    // huge page backed ranges must be committed in whole huge pages
+    uint64_t granule = (arena->flags & ARENA_HUGE_PAGES)
+                           ? vmem_huge_page_size()
+                           : COMMIT_GRANULE;
+    uint64_t target = align_up(end, granule);
+    if (target > arena->total_size) target = arena->total_size;
+
+    uint8_t *start = (uint8_t *)arena->memory + arena->committed;
+    if (!vmem_commit(start, target - arena->committed)) {
+        return false;
+    }
+    if (arena->flags & ARENA_PREFAULT) {
+        vmem_prefault(start, target - arena->committed);
+    }
+
+    arena->committed = target;
+    return true;
+}
+
+static void *chain_alloc(arena_alloc_t *arena, uint64_t size,
+                         uint8_t alignment) {
+    arena_block_t *block = arena->chain;
+    if (block) {
+        uint8_t *base = (uint8_t *)(block + 1);
+        uint64_t offset = align_up((uint64_t)(uintptr_t)(base + block->used),
+                                   alignment) -
+                          (uint64_t)(uintptr_t)base;
+        if (offset + size <= block->size) {
+            block->used = offset + size;
+            return base + offset;
+        }
+    }
+
+    uint64_t block_size = MAX(CHAIN_BLOCK_SIZE, size + alignment);
+    block = WALLOC(sizeof(arena_block_t) + block_size, MEM_ARENA);
+    if (!block) return NULL;
+
+    block->prev = arena->chain;
+    block->size = block_size;
+    arena->chain = block;
+    arena->chain_size += block_size;
+
+    uint8_t *base = (uint8_t *)(block + 1);
+    uint64_t offset = align_up((uint64_t)(uintptr_t)base, alignment) -
+                      (uint64_t)(uintptr_t)base;
+    block->used = offset + size;
+
+    return base + offset;
+}
+
 void *arena_alloc_align(arena_alloc_t *arena, uint64_t size,
                         uint8_t alignment) {
     if (!arena || size == 0) return NULL;
 
-    uint64_t aligned_offset =
-        (arena->curr_offset + (alignment - 1)) & ~((uint64_t)alignment - 1);
+    uint64_t aligned_offset = align_up(arena->curr_offset, alignment);
 
-    if (aligned_offset + size > arena->total_size) {
+    if (aligned_offset + size > arena->total_size ||
+        ((arena->flags & ARENA_VIRTUAL) &&
+         !arena_commit(arena, aligned_offset + size))) {
+        arena->overflow_count++;
+        if (arena->flags & ARENA_CHAINED) {
+            return chain_alloc(arena, size, alignment);
+        }
         return NULL;
     }
 
@@ -56,9 +184,38 @@ void *arena_alloc(arena_alloc_t *arena, uint64_t size) {
 
 void arena_reset(arena_alloc_t *arena) {
     if (arena) {
+        uint64_t used = arena_used(arena);
+        if (used > arena->high_water) arena->high_water = used;
+
+        chain_free(arena, NULL);
         arena->prev_offset = 0;
         arena->curr_offset = 0;
+        arena->overflow_count = 0;
+    }
+}
+
+arena_temp_t arena_temp_begin(arena_alloc_t *arena) {
+    arena_temp_t temp = {.arena = arena};
+    if (arena) {
+        temp.offset = arena->curr_offset;
+        temp.chain = arena->chain;
+        temp.chain_used = arena->chain ? arena->chain->used : 0;
     }
+    return temp;
+}
+
+void arena_temp_end(arena_temp_t temp) {
+    arena_alloc_t *arena = temp.arena;
+    if (!arena) return;
+
+    uint64_t used = arena_used(arena);
+    if (used > arena->high_water) arena->high_water = used;
+
+    chain_free(arena, temp.chain);
+    if (arena->chain) arena->chain->used = temp.chain_used;
+
+    arena->prev_offset = temp.offset;
+    arena->curr_offset = temp.offset;
 }
 
 uint64_t arena_remaining(const arena_alloc_t *arena) {
@@ -66,5 +223,19 @@ uint64_t arena_remaining(const arena_alloc_t *arena) {
 }
 
 uint64_t arena_used(const arena_alloc_t *arena) {
-    return arena ? arena->curr_offset : 0;
+    if (!arena) return 0;
+
+    uint64_t used = arena->curr_offset;
+    for (const arena_block_t *b = arena->chain; b; b = b->prev) {
+        used += b->used;
+    }
+    return used;
+}
+
+uint64_t arena_committed(const arena_alloc_t *arena) {
+    return arena ? arena->committed + arena->chain_size : 0;
+}
+
+uint64_t arena_reserved(const arena_alloc_t *arena) {
+    return arena ? arena->total_size + arena->chain_size : 0;
 }
@@ -3,22 +3,67 @@
 
 #include "define.h"
 
+typedef enum {
+    ARENA_FIXED = 0x00,
+    // reserve address space up front and commit pages as the arena grows
+    ARENA_VIRTUAL = 0x01,
+    // when the main region is exhausted, continue in heap-allocated blocks
+    ARENA_CHAINED = 0x02,
+    // back with huge pages where the system allows it (implies VIRTUAL)
+    ARENA_HUGE_PAGES = 0x04,
+    // commit and fault in the whole reservation at creation (implies VIRTUAL)
+    ARENA_PREFAULT = 0x08
+} arena_flag_t;
+
+typedef struct arena_block {
+    struct arena_block *prev;
+    uint64_t size;
+    uint64_t used;
+} arena_block_t;
+
 typedef struct {
     uint64_t total_size;
     uint64_t prev_offset;
     uint64_t curr_offset;
     void *memory;
     bool own_memory;
+
+    uint32_t flags;
+    uint64_t committed;
+    arena_block_t *chain;
+    uint64_t chain_size;
+
+    uint64_t high_water;
+    uint32_t overflow_count;
 } arena_alloc_t;
 
+// Save point for scratch allocations, everything allocated after begin is
+// released by end. Scopes must be closed in LIFO order.
+typedef struct {
+    arena_alloc_t *arena;
+    uint64_t offset;
+    arena_block_t *chain;
+    uint64_t chain_used;
+} arena_temp_t;
+
 bool arena_create(uint64_t total_size, arena_alloc_t *arena, void *memory);
+bool arena_create_ex(uint64_t reserve_size, uint32_t flags,
+                     arena_alloc_t *arena);
 void arena_kill(arena_alloc_t *arena);
 
 void *arena_alloc_align(arena_alloc_t *arena, uint64_t size, uint8_t alignment);
 void *arena_alloc(arena_alloc_t *arena, uint64_t size);
 void arena_reset(arena_alloc_t *arena);
 
-uint64_t arena_remaining(const arena_alloc_t *arena);
+arena_temp_t arena_temp_begin(arena_alloc_t *arena);
+void arena_temp_end(arena_temp_t temp);
+
+// bytes handed out, including chained blocks
 uint64_t arena_used(const arena_alloc_t *arena);
+// bytes left before the arena has to chain or fail
+uint64_t arena_remaining(const arena_alloc_t *arena);
+// bytes backed by physical memory / bytes of address space held
+uint64_t arena_committed(const arena_alloc_t *arena);
+uint64_t arena_reserved(const arena_alloc_t *arena);
 
 #endif // ARENA_ALLOC_H
@@ -55,6 +55,7 @@ void camera_update(camera_system_t *cam) {
         }
         */
         cam->main_cam.dirty = false;
+        cam->main_cam.revision++;
     }
 }
 
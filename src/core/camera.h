@@ -15,6 +15,7 @@ typedef struct {
     vec3 rotation;
 
     bool dirty;
+    uint32_t revision; // bumped whenever the view or projection changes
 } camera_t;
 
 typedef struct {
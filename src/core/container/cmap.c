@@ -0,0 +1,122 @@
+#include "cmap.h"
+#include "map.h"
+#include "platform/thread.h"
+
+#include <string.h>
+
+MAP_DEFINE_U64(cmap_table, void *)
+
+// one cache line apart so stripe locks don't false-share
+struct cmap_stripe_t {
+    mutex_t lock;
+    cmap_table_t table;
+    uint64_t acquired;
+    uint64_t contended;
+} ALIGN(64);
+
+static INL cmap_stripe_t *stripe_of(cmap_t *map, uint64_t key) {
+    // top bits pick one of 16 stripes, the stripe table probes with the low
+    uint64_t hash = map_hash_u64(key);
+    return &map->stripes[hash >> 60];
+}
+
+static void stripe_lock(cmap_stripe_t *stripe) {
+    if (!mutex_trylock(&stripe->lock)) {
+        ATOMIC_ADD(&stripe->contended, 1);
+        mutex_lock(&stripe->lock);
+    }
+    ATOMIC_ADD(&stripe->acquired, 1);
+}
+
+bool cmap_create(cmap_t *map, arena_alloc_t *arena, uint32_t capacity) {
+    memset(map, 0, sizeof(cmap_t));
+    map->stripes =
+        arena_alloc_align(arena, sizeof(cmap_stripe_t) * CMAP_STRIPES, 64);
+    if (!map->stripes) return false;
+
+    memset(map->stripes, 0, sizeof(cmap_stripe_t) * CMAP_STRIPES);
+    for (uint32_t i = 0; i < CMAP_STRIPES; ++i) {
+        cmap_stripe_t *stripe = &map->stripes[i];
+        if (!mutex_create(&stripe->lock) ||
+            !cmap_table_init(&stripe->table, capacity / CMAP_STRIPES + 1)) {
+            LOG_ERROR("failed to create concurrent map stripe %u", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+void cmap_kill(cmap_t *map) {
+    if (!map->stripes) return;
+
+    for (uint32_t i = 0; i < CMAP_STRIPES; ++i) {
+        cmap_table_kill(&map->stripes[i].table);
+        mutex_kill(&map->stripes[i].lock);
+    }
+    memset(map, 0, sizeof(cmap_t));
+}
+
+void *cmap_get(cmap_t *map, uint64_t key) {
+    cmap_stripe_t *stripe = stripe_of(map, key);
+
+    stripe_lock(stripe);
+    void **found = cmap_table_get(&stripe->table, key);
+    void *value = found ? *found : NULL;
+    mutex_unlock(&stripe->lock);
+
+    return value;
+}
+
+void *cmap_get_or_create(cmap_t *map, uint64_t key, cmap_create_fn create,
+                         cmap_destroy_fn destroy, void *user, bool *inserted) {
+    cmap_stripe_t *stripe = stripe_of(map, key);
+    void *value = NULL;
+    bool created = false;
+
+    stripe_lock(stripe);
+    void **found = cmap_table_get(&stripe->table, key);
+    if (found) {
+        value = *found;
+    } else {
+        value = create(key, user);
+        if (value && cmap_table_set(&stripe->table, key, value)) {
+            created = true;
+        } else if (value) {
+            // nobody could find it again, hand it back instead
+            if (destroy) destroy(key, value, user);
+            value = NULL;
+        }
+    }
+    mutex_unlock(&stripe->lock);
+
+    if (inserted) *inserted = created;
+    return value;
+}
+
+bool cmap_remove(cmap_t *map, uint64_t key) {
+    cmap_stripe_t *stripe = stripe_of(map, key);
+
+    stripe_lock(stripe);
+    bool removed = cmap_table_remove(&stripe->table, key);
+    mutex_unlock(&stripe->lock);
+
+    return removed;
+}
+
+uint32_t cmap_count(cmap_t *map) {
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < CMAP_STRIPES; ++i) {
+        count += ATOMIC_LOAD(&map->stripes[i].table.count);
+    }
+    return count;
+}
+
+void cmap_lock_stats(const cmap_t *map, uint64_t *acquired,
+                     uint64_t *contended) {
+    *acquired = 0;
+    *contended = 0;
+    for (uint32_t i = 0; i < CMAP_STRIPES; ++i) {
+        *acquired += ATOMIC_LOAD(&map->stripes[i].acquired);
+        *contended += ATOMIC_LOAD(&map->stripes[i].contended);
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef CMAP_H
+#define CMAP_H
+
+#include "core/define.h"
+#include "core/arena.h"
+
+// Concurrent u64 -> pointer map. Keys are spread over CMAP_STRIPES
+// independent tables, each behind its own lock, so threads touching
+// different keys rarely meet on the same mutex.
+#define CMAP_STRIPES 16
+
+typedef struct cmap_stripe_t cmap_stripe_t;
+
+typedef struct {
+    cmap_stripe_t *stripes;
+} cmap_t;
+
+// Called under the stripe lock when the key is missing. Keep it cheap (claim
+// a slot, mark it loading), do the actual work after it returns.
+typedef void *(*cmap_create_fn)(uint64_t key, void *user);
+// Gets back a created value the table had no room for, also under the lock.
+typedef void (*cmap_destroy_fn)(uint64_t key, void *value, void *user);
+
+bool cmap_create(cmap_t *map, arena_alloc_t *arena, uint32_t capacity);
+void cmap_kill(cmap_t *map);
+
+void *cmap_get(cmap_t *map, uint64_t key);
+// Returns the value under `key`, creating it through `create` if absent.
+// Exactly one caller sees `inserted == true` for a given key. NULL when
+// `create` fails or the insert does, `destroy` (optional) then undoes it.
+void *cmap_get_or_create(cmap_t *map, uint64_t key, cmap_create_fn create,
+                         cmap_destroy_fn destroy, void *user, bool *inserted);
+bool cmap_remove(cmap_t *map, uint64_t key);
+
+uint32_t cmap_count(cmap_t *map);
+void cmap_lock_stats(const cmap_t *map, uint64_t *acquired,
+                     uint64_t *contended);
+
+#endif // CMAP_H
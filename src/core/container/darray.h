@@ -0,0 +1,96 @@
+#ifndef DARRAY_H
+#define DARRAY_H
+
+#include "core/define.h"
+#include "core/arena.h"
+#include "core/memory.h"
+
+#include <string.h>
+
+// Type-specialized growable array. DARRAY_DEFINE(name, type) generates
+// `name_t` and its functions. Arrays created with an arena grow by copying
+// into a fresh arena block and never free, heap arrays use WALLOC.
+//
+//   DARRAY_DEFINE(u32_array, uint32_t)
+//   u32_array_t a;
+//   u32_array_init(&a, NULL, 16);
+//   u32_array_push(&a, 7);
+
+#define DARRAY_MIN_CAPACITY 8
+
+#define DARRAY_DEFINE(name, type)                                              \
+typedef struct {                                                               \
+    type *data;                                                                \
+    uint32_t count;                                                            \
+    uint32_t capacity;                                                         \
+    arena_alloc_t *arena;                                                      \
+} name##_t;                                                                    \
+                                                                               \
+static inline bool name##_reserve(name##_t *arr, uint32_t capacity) {          \
+    if (capacity <= arr->capacity) return true;                                \
+                                                                               \
+    uint32_t grow = arr->capacity ? arr->capacity * 2 : DARRAY_MIN_CAPACITY;   \
+    if (grow > capacity) capacity = grow;                                      \
+                                                                               \
+    uint64_t size = sizeof(type) * (uint64_t)capacity;                         \
+    type *data = arr->arena                                                    \
+                     ? arena_alloc_align(arr->arena, size, 16)                 \
+                     : WALLOC(size, MEM_DYNARRAY);                             \
+    if (!data) return false;                                                   \
+                                                                               \
+    if (arr->count) memcpy(data, arr->data, sizeof(type) * arr->count);        \
+    if (!arr->arena && arr->data) {                                            \
+        WFREE(arr->data, sizeof(type) * (uint64_t)arr->capacity,               \
+              MEM_DYNARRAY);                                                   \
+    }                                                                          \
+    arr->data = data;                                                          \
+    arr->capacity = capacity;                                                  \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+static inline bool name##_init(name##_t *arr, arena_alloc_t *arena,            \
+                            uint32_t capacity) {                               \
+    memset(arr, 0, sizeof(*arr));                                              \
+    arr->arena = arena;                                                        \
+    return capacity ? name##_reserve(arr, capacity) : true;                    \
+}                                                                              \
+                                                                               \
+static inline void name##_kill(name##_t *arr) {                                \
+    if (!arr->arena && arr->data) {                                            \
+        WFREE(arr->data, sizeof(type) * (uint64_t)arr->capacity,               \
+              MEM_DYNARRAY);                                                   \
+    }                                                                          \
+    memset(arr, 0, sizeof(*arr));                                              \
+}                                                                              \
+                                                                               \
+static INL type *name##_push(name##_t *arr, type value) {                      \
+    if (arr->count == arr->capacity && !name##_reserve(arr, arr->count + 1)) { \
+        return NULL;                                                           \
+    }                                                                          \
+    arr->data[arr->count] = value;                                             \
+    return &arr->data[arr->count++];                                           \
+}                                                                              \
+                                                                               \
+static INL type *name##_push_zero(name##_t *arr) {                             \
+    if (arr->count == arr->capacity && !name##_reserve(arr, arr->count + 1)) { \
+        return NULL;                                                           \
+    }                                                                          \
+    memset(&arr->data[arr->count], 0, sizeof(type));                           \
+    return &arr->data[arr->count++];                                           \
+}                                                                              \
+                                                                               \
+static INL bool name##_pop(name##_t *arr, type *out) {                         \
+    if (arr->count == 0) return false;                                         \
+    arr->count--;                                                              \
+    if (out) *out = arr->data[arr->count];                                     \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+/* order is not kept, the last element fills the hole */                       \
+static INL void name##_remove_swap(name##_t *arr, uint32_t index) {            \
+    arr->data[index] = arr->data[--arr->count];                                \
+}                                                                              \
+                                                                               \
+static INL void name##_clear(name##_t *arr) { arr->count = 0; }
+
+#endif // DARRAY_H
@@ -1,100 +1,343 @@
 #include "hash.h"
+#include "core/memory.h"
 
 #include <string.h>
 
+#if defined(__SSE2__)
+#    include <emmintrin.h>
+#endif
+
+// SwissTable layout: one control byte per slot holding either EMPTY, DELETED
+// or the low 7 bits of the slot's hash. The first GROUP_WIDTH - 1 control
+// bytes are mirrored past the end so any 16 byte window can be loaded.
+#define GROUP_WIDTH 16
+#define CTRL_EMPTY ((uint8_t)0x80)
+#define CTRL_DELETED ((uint8_t)0xFE)
+#define MIN_CAPACITY 16
+// Keys up to INLINE_KEY - 1 bytes live in the slot, whose last key byte is
+// then 0 (the terminator at worst). Longer keys are WALLOC'd and flagged by
+// LONG_KEY in that byte.
+#define INLINE_KEY 24
+#define LONG_KEY 1
+
 typedef struct {
-    const char *key;
+    uint64_t hash;
     uint64_t value;
-    bool used;
-} hash_entry_t;
+    union {
+        char inline_key[INLINE_KEY];
+        struct {
+            char *ptr;
+            uint64_t size; // with the terminator
+        } heap;
+    } key;
+} hash_slot_t;
 
 struct hash_table_t {
-    hash_entry_t *entries;
+    uint8_t *ctrl;
+    hash_slot_t *slots;
     uint32_t capacity;
     uint32_t count;
+    uint32_t growth_left;
     arena_alloc_t *arena;
 };
 
-static uint32_t do_hash(const char *key) {
-    uint32_t hash = 0;
-    while (*key) {
-        hash = (hash * 31) + (uint32_t)*key++;
+uint64_t hash_bytes(const void *data, uint64_t len) {
+    const uint8_t *p = data;
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ (len * 0xFF51AFD7ED558CCDull);
+
+    while (len >= 8) {
+        uint64_t k;
+        memcpy(&k, p, 8);
+        h = (h ^ (k * 0x87C37B91114253D5ull)) * 0x4CF5AD432745937Full;
+        h ^= h >> 31;
+        p += 8;
+        len -= 8;
+    }
+
+    uint64_t tail = 0;
+    memcpy(&tail, p, len);
+    h = (h ^ (tail * 0x87C37B91114253D5ull)) * 0x4CF5AD432745937Full;
+
+    // murmur3 finalizer
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+uint64_t hash_str(const char *key) {
+    return hash_bytes(key, strlen(key));
+}
+
+static INL uint8_t hash_h2(uint64_t hash) {
+    return (uint8_t)(hash & 0x7F);
+}
+
+static INL uint32_t hash_h1(uint64_t hash) {
+    return (uint32_t)(hash >> 7);
+}
+
+static INL bool slot_long(const hash_slot_t *slot) {
+    return slot->key.inline_key[INLINE_KEY - 1] == LONG_KEY;
+}
+
+// `size` counts the terminator, so prefixes never match
+static INL bool slot_key_eq(const hash_slot_t *slot, const char *key,
+                            uint64_t size) {
+    if (slot_long(slot)) {
+        return slot->key.heap.size == size &&
+               memcmp(slot->key.heap.ptr, key, size) == 0;
+    }
+    return size <= INLINE_KEY && memcmp(slot->key.inline_key, key, size) == 0;
+}
+
+static INL uint32_t match_byte(const uint8_t *ctrl, uint8_t value) {
+#if defined(__SSE2__)
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    __m128i match = _mm_cmpeq_epi8(group, _mm_set1_epi8((char)value));
+    return (uint32_t)_mm_movemask_epi8(match);
+#else
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < GROUP_WIDTH; ++i) {
+        if (ctrl[i] == value) mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+// EMPTY and DELETED are the only control values with the top bit set
+static INL uint32_t match_empty_or_deleted(const uint8_t *ctrl) {
+#if defined(__SSE2__)
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return (uint32_t)_mm_movemask_epi8(group);
+#else
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < GROUP_WIDTH; ++i) {
+        if (ctrl[i] & 0x80) mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+static INL void set_ctrl(hash_table_t *hash, uint32_t index, uint8_t value) {
+    hash->ctrl[index] = value;
+    if (index < GROUP_WIDTH - 1) hash->ctrl[hash->capacity + index] = value;
+}
+
+static INL uint32_t max_load(uint32_t capacity) {
+    return capacity - capacity / 8;
+}
+
+static bool table_alloc(hash_table_t *hash, uint32_t capacity) {
+    uint64_t ctrl_size = capacity + GROUP_WIDTH - 1;
+    uint8_t *ctrl = WALLOC(ctrl_size, MEM_ARRAY);
+    hash_slot_t *slots = WALLOC(sizeof(hash_slot_t) * capacity, MEM_ARRAY);
+    if (!ctrl || !slots) {
+        WFREE(ctrl, ctrl_size, MEM_ARRAY);
+        WFREE(slots, sizeof(hash_slot_t) * capacity, MEM_ARRAY);
+        return false;
+    }
+
+    memset(ctrl, CTRL_EMPTY, ctrl_size);
+    hash->ctrl = ctrl;
+    hash->slots = slots;
+    hash->capacity = capacity;
+    hash->growth_left = max_load(capacity) - hash->count;
+    return true;
+}
+
+static void table_free(uint8_t *ctrl, hash_slot_t *slots, uint32_t capacity) {
+    WFREE(ctrl, capacity + GROUP_WIDTH - 1, MEM_ARRAY);
+    WFREE(slots, sizeof(hash_slot_t) * capacity, MEM_ARRAY);
+}
+
+// first EMPTY or DELETED slot on the probe sequence of `h`
+static uint32_t find_insert_slot(const hash_table_t *hash, uint64_t h) {
+    uint32_t mask = hash->capacity - 1;
+    uint32_t pos = hash_h1(h) & mask;
+    uint32_t stride = 0;
+
+    for (;;) {
+        uint32_t free = match_empty_or_deleted(hash->ctrl + pos);
+        if (free) return (pos + (uint32_t)__builtin_ctz(free)) & mask;
+
+        stride += GROUP_WIDTH;
+        pos = (pos + stride) & mask;
+    }
+}
+
+static bool rehash(hash_table_t *hash, uint32_t capacity) {
+    uint8_t *old_ctrl = hash->ctrl;
+    hash_slot_t *old_slots = hash->slots;
+    uint32_t old_capacity = hash->capacity;
+
+    if (!table_alloc(hash, capacity)) {
+        hash->ctrl = old_ctrl;
+        hash->slots = old_slots;
+        return false;
+    }
+
+    for (uint32_t i = 0; i < old_capacity; ++i) {
+        if (old_ctrl[i] & 0x80) continue;
+
+        hash_slot_t *slot = &old_slots[i];
+        uint32_t index = find_insert_slot(hash, slot->hash);
+        set_ctrl(hash, index, hash_h2(slot->hash));
+        hash->slots[index] = *slot;
+    }
+
+    table_free(old_ctrl, old_slots, old_capacity);
+    return true;
+}
+
+static int64_t find(const hash_table_t *hash, const char *key, uint64_t size,
+                    uint64_t h) {
+    uint32_t mask = hash->capacity - 1;
+    uint32_t pos = hash_h1(h) & mask;
+    uint32_t stride = 0;
+    uint8_t h2 = hash_h2(h);
+
+    // the match is almost always at or just past `pos`, overlap its cache
+    // miss with the control byte one
+    __builtin_prefetch(&hash->slots[pos]);
+
+    for (;;) {
+        const uint8_t *group = hash->ctrl + pos;
+        uint32_t match = match_byte(group, h2);
+        while (match) {
+            uint32_t index = (pos + (uint32_t)__builtin_ctz(match)) & mask;
+            const hash_slot_t *slot = &hash->slots[index];
+            // full hash first, the key compare almost always succeeds
+            if (slot->hash == h && slot_key_eq(slot, key, size)) {
+                return index;
+            }
+            match &= match - 1;
+        }
+        if (match_byte(group, CTRL_EMPTY)) return -1;
+
+        stride += GROUP_WIDTH;
+        if (stride > hash->capacity) return -1;
+        pos = (pos + stride) & mask;
     }
-    return hash;
 }
 
 hash_table_t *hash_create(arena_alloc_t *arena, uint32_t capacity) {
     hash_table_t *hash = arena_alloc(arena, sizeof(hash_table_t));
+    if (!hash) return NULL;
 
+    memset(hash, 0, sizeof(hash_table_t));
     hash->arena = arena;
-    hash->capacity = capacity;
-    hash->count = 0;
-    hash->entries = arena_alloc(arena, sizeof(hash_entry_t) * capacity);
-    memset(hash->entries, 0, sizeof(hash_entry_t) * capacity);
+
+    // room for `capacity` keys under the 7/8 load limit
+    uint32_t size = MIN_CAPACITY;
+    while (max_load(size) < capacity) {
+        size *= 2;
+    }
+
+    if (!table_alloc(hash, size)) return NULL;
     return hash;
 }
 
+static INL void free_key(hash_slot_t *slot) {
+    if (slot_long(slot)) {
+        WFREE(slot->key.heap.ptr, slot->key.heap.size, MEM_STRING);
+    }
+}
+
 void hash_kill(hash_table_t *hash) {
-    if (hash) memset(hash, 0, sizeof(hash_table_t));
+    if (!hash) return;
+
+    for (uint32_t i = 0; i < hash->capacity; ++i) {
+        if (hash->ctrl[i] & 0x80) continue;
+        free_key(&hash->slots[i]);
+    }
+    table_free(hash->ctrl, hash->slots, hash->capacity);
+    memset(hash, 0, sizeof(hash_table_t));
 }
 
 bool hash_set(hash_table_t *hash, const char *key, uint64_t value) {
-    if (hash->count >= hash->capacity) return false;
+    uint64_t len = strlen(key);
+    uint64_t h = hash_bytes(key, len);
 
-    uint32_t index = do_hash(key) % hash->capacity;
+    int64_t found = find(hash, key, len + 1, h);
+    if (found >= 0) {
+        hash->slots[found].value = value;
+        return true;
+    }
 
-    for (uint32_t i = 0; i < hash->capacity; ++i) {
-        uint32_t slot = (index + i) % hash->capacity;
-        hash_entry_t *entry = &hash->entries[slot];
-
-        if (!entry->used) {
-            uint64_t key_len = strlen(key) + 1;
-            entry->key = arena_alloc(hash->arena, key_len);
-            memcpy((void *)entry->key, key, key_len);
-
-            entry->value = value;
-            entry->used = true;
-            hash->count++;
-            return true;
-        }
+    uint32_t index = find_insert_slot(hash, h);
+    if (hash->growth_left == 0 && hash->ctrl[index] == CTRL_EMPTY) {
+        // mostly tombstones: rebuild in place, otherwise double
+        uint32_t capacity = hash->count < max_load(hash->capacity) / 2
+                                ? hash->capacity
+                                : hash->capacity * 2;
+        if (!rehash(hash, capacity)) return false;
+        index = find_insert_slot(hash, h);
+    }
 
-        if (entry->used && strcmp(entry->key, key) == 0) {
-            entry->value = value;
-            return true;
-        }
+    // free slots are all zero, see hash_remove
+    hash_slot_t *slot = &hash->slots[index];
+    if (len < INLINE_KEY) {
+        memcpy(slot->key.inline_key, key, len + 1);
+    } else {
+        char *copy = WALLOC(len + 1, MEM_STRING);
+        if (!copy) return false;
+        memcpy(copy, key, len + 1);
+        slot->key.heap.ptr = copy;
+        slot->key.heap.size = len + 1;
+        slot->key.inline_key[INLINE_KEY - 1] = LONG_KEY;
     }
-    return false;
+    slot->hash = h;
+    slot->value = value;
+
+    if (hash->ctrl[index] == CTRL_EMPTY) hash->growth_left--;
+    set_ctrl(hash, index, hash_h2(h));
+    hash->count++;
+
+    return true;
 }
 
 bool hash_get(hash_table_t *hash, const char *key, uint64_t *out) {
-    uint32_t index = do_hash(key) % hash->capacity;
-
-    for (uint32_t i = 0; i < hash->capacity; ++i) {
-        uint32_t slot = (index + 1) % hash->capacity;
-        hash_entry_t *entry = &hash->entries[slot];
+    uint64_t len = strlen(key);
+    int64_t found = find(hash, key, len + 1, hash_bytes(key, len));
+    if (found < 0) return false;
 
-        if (!entry->used) return false;
-        if (strcmp(entry->key, key) == 0) {
-            *out = entry->value;
-            return true;
-        }
-    }
-    return false;
+    *out = hash->slots[found].value;
+    return true;
 }
 
 bool hash_remove(hash_table_t *hash, const char *key) {
-    uint32_t index = do_hash(key) & hash->capacity;
+    uint64_t len = strlen(key);
+    int64_t found = find(hash, key, len + 1, hash_bytes(key, len));
+    if (found < 0) return false;
 
-    for (uint32_t i = 0; i < hash->capacity; ++i) {
-        uint32_t slot = (index + 1) % hash->capacity;
-        hash_entry_t *entry = &hash->entries[slot];
-
-        if (!entry->used) return false;
-        if (strcmp(entry->key, key) == 0) {
-            entry->used = false;
-            hash->count--;
-            return true;
-        }
+    uint32_t index = (uint32_t)found;
+    uint32_t mask = hash->capacity - 1;
+    hash_slot_t *slot = &hash->slots[index];
+    free_key(slot);
+    memset(slot, 0, sizeof(hash_slot_t));
+
+    // a slot can go back to EMPTY only if no probe window that covers it
+    // was ever seen full, otherwise lookups could stop early
+    uint32_t before = match_byte(hash->ctrl + ((index - GROUP_WIDTH) & mask),
+                                 CTRL_EMPTY);
+    uint32_t after = match_byte(hash->ctrl + index, CTRL_EMPTY);
+    uint32_t lead = before ? (uint32_t)__builtin_clz(before << 16) : 16;
+    uint32_t trail = after ? (uint32_t)__builtin_ctz(after) : 16;
+
+    if (lead + trail < GROUP_WIDTH) {
+        set_ctrl(hash, index, CTRL_EMPTY);
+        hash->growth_left++;
+    } else {
+        set_ctrl(hash, index, CTRL_DELETED);
     }
-    return false;
+    hash->count--;
+
+    return true;
+}
+
+uint32_t hash_count(const hash_table_t *hash) {
+    return hash ? hash->count : 0;
 }
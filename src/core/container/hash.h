@@ -4,6 +4,9 @@
 #include "core/define.h"
 #include "core/arena.h"
 
+// String keyed hash map. Keys are copied, the table grows by rehashing into a
+// power-of-two capacity and lookups probe 16 control bytes at a time. Short
+// keys are stored in the slot itself.
 typedef struct hash_table_t hash_table_t;
 
 hash_table_t *hash_create(arena_alloc_t *arena, uint32_t capacity);
@@ -13,4 +16,9 @@ bool hash_set(hash_table_t *hash, const char *key, uint64_t value);
 bool hash_get(hash_table_t *hash, const char *key, uint64_t *out);
 bool hash_remove(hash_table_t *hash, const char *key);
 
+uint32_t hash_count(const hash_table_t *hash);
+
+uint64_t hash_bytes(const void *data, uint64_t len);
+uint64_t hash_str(const char *key);
+
 #endif // HASH_H
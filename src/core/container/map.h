@@ -0,0 +1,168 @@
+#ifndef MAP_H
+#define MAP_H
+
+#include "core/define.h"
+#include "core/memory.h"
+
+#include <string.h>
+
+// Integer and pointer keyed hash maps, no string hashing involved. Open
+// addressing with linear probing, grows at 3/4 load and deletes by shifting
+// the probe run back so no tombstones build up.
+//
+//   MAP_DEFINE_U64(handle_map, uint32_t)
+//   MAP_DEFINE_PTR(owner_map, render_system_t *)
+//
+// generate `name_t` with `name_init/kill/get/set/remove`. Occupied slots are
+// flagged in `used[]` for iteration.
+
+#define MAP_MIN_CAPACITY 16
+
+// murmur3 finalizer, spreads sequential ids and aligned pointers
+static INL uint64_t map_hash_u64(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDull;
+    key ^= key >> 33;
+    key *= 0xC4CEB9FE1A85EC53ull;
+    key ^= key >> 33;
+    return key;
+}
+
+#define MAP_DEFINE_U64(name, value_type)                                       \
+    MAP_DEFINE(name, uint64_t, value_type, (uint64_t))
+
+#define MAP_DEFINE_PTR(name, value_type)                                       \
+    MAP_DEFINE(name, const void *, value_type, (uint64_t)(uintptr_t))
+
+#define MAP_DEFINE(name, key_type, value_type, to_u64)                         \
+typedef struct {                                                               \
+    key_type *keys;                                                            \
+    value_type *values;                                                        \
+    uint8_t *used;                                                             \
+    uint32_t capacity;                                                         \
+    uint32_t count;                                                            \
+} name##_t;                                                                    \
+                                                                               \
+static INL uint32_t name##_slot(const name##_t *map, key_type key) {           \
+    return (uint32_t)map_hash_u64(to_u64(key)) & (map->capacity - 1);          \
+}                                                                              \
+                                                                               \
+static inline bool name##_alloc(name##_t *map, uint32_t capacity) {            \
+    map->keys = WALLOC(sizeof(key_type) * capacity, MEM_DYNARRAY);             \
+    map->values = WALLOC(sizeof(value_type) * capacity, MEM_DYNARRAY);         \
+    map->used = WALLOC(capacity, MEM_DYNARRAY);                                \
+    map->capacity = capacity;                                                  \
+    if (!map->keys || !map->values || !map->used) return false;                \
+                                                                               \
+    memset(map->used, 0, capacity);                                            \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+static inline void name##_free(key_type *keys, value_type *values,             \
+                               uint8_t *used, uint32_t capacity) {             \
+    WFREE(keys, sizeof(key_type) * capacity, MEM_DYNARRAY);                    \
+    WFREE(values, sizeof(value_type) * capacity, MEM_DYNARRAY);                \
+    WFREE(used, capacity, MEM_DYNARRAY);                                       \
+}                                                                              \
+                                                                               \
+static inline bool name##_init(name##_t *map, uint32_t capacity) {             \
+    memset(map, 0, sizeof(*map));                                              \
+                                                                               \
+    uint32_t size = MAP_MIN_CAPACITY;                                          \
+    while (size - size / 4 < capacity) size *= 2;                              \
+                                                                               \
+    if (!name##_alloc(map, size)) {                                            \
+        name##_free(map->keys, map->values, map->used, size);                  \
+        memset(map, 0, sizeof(*map));                                          \
+        return false;                                                          \
+    }                                                                          \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+static inline void name##_kill(name##_t *map) {                                \
+    name##_free(map->keys, map->values, map->used, map->capacity);             \
+    memset(map, 0, sizeof(*map));                                              \
+}                                                                              \
+                                                                               \
+static INL value_type *name##_get(const name##_t *map, key_type key) {         \
+    uint32_t mask = map->capacity - 1;                                         \
+    for (uint32_t i = name##_slot(map, key); map->used[i];                     \
+         i = (i + 1) & mask) {                                                 \
+        if (map->keys[i] == key) return &map->values[i];                       \
+    }                                                                          \
+    return NULL;                                                               \
+}                                                                              \
+                                                                               \
+static inline bool name##_grow(name##_t *map) {                                \
+    name##_t old = *map;                                                       \
+    if (!name##_alloc(map, old.capacity * 2)) {                                \
+        name##_free(map->keys, map->values, map->used, map->capacity);         \
+        *map = old;                                                            \
+        return false;                                                          \
+    }                                                                          \
+                                                                               \
+    uint32_t mask = map->capacity - 1;                                         \
+    for (uint32_t i = 0; i < old.capacity; ++i) {                              \
+        if (!old.used[i]) continue;                                            \
+                                                                               \
+        uint32_t slot = name##_slot(map, old.keys[i]);                         \
+        while (map->used[slot]) slot = (slot + 1) & mask;                      \
+        map->used[slot] = 1;                                                   \
+        map->keys[slot] = old.keys[i];                                         \
+        map->values[slot] = old.values[i];                                     \
+    }                                                                          \
+                                                                               \
+    name##_free(old.keys, old.values, old.used, old.capacity);                 \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+static inline value_type *name##_set(name##_t *map, key_type key,              \
+                                     value_type value) {                       \
+    value_type *found = name##_get(map, key);                                  \
+    if (found) {                                                               \
+        *found = value;                                                        \
+        return found;                                                          \
+    }                                                                          \
+                                                                               \
+    if (map->count + 1 > map->capacity - map->capacity / 4 &&                  \
+        !name##_grow(map)) {                                                   \
+        return NULL;                                                           \
+    }                                                                          \
+                                                                               \
+    uint32_t mask = map->capacity - 1;                                         \
+    uint32_t slot = name##_slot(map, key);                                     \
+    while (map->used[slot]) slot = (slot + 1) & mask;                          \
+                                                                               \
+    map->used[slot] = 1;                                                       \
+    map->keys[slot] = key;                                                     \
+    map->values[slot] = value;                                                 \
+    map->count++;                                                              \
+    return &map->values[slot];                                                 \
+}                                                                              \
+                                                                               \
+static inline bool name##_remove(name##_t *map, key_type key) {                \
+    uint32_t mask = map->capacity - 1;                                         \
+    uint32_t hole = name##_slot(map, key);                                     \
+    while (map->used[hole] && map->keys[hole] != key) {                        \
+        hole = (hole + 1) & mask;                                              \
+    }                                                                          \
+    if (!map->used[hole]) return false;                                        \
+                                                                               \
+    /* backward shift: pull later entries of the run into the hole */          \
+    uint32_t next = (hole + 1) & mask;                                         \
+    while (map->used[next]) {                                                  \
+        uint32_t home = name##_slot(map, map->keys[next]);                     \
+        if (((next - home) & mask) >= ((next - hole) & mask)) {                \
+            map->keys[hole] = map->keys[next];                                 \
+            map->values[hole] = map->values[next];                             \
+            hole = next;                                                       \
+        }                                                                      \
+        next = (next + 1) & mask;                                              \
+    }                                                                          \
+                                                                               \
+    map->used[hole] = 0;                                                       \
+    map->count--;                                                              \
+    return true;                                                               \
+}
+
+#endif // MAP_H
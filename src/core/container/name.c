@@ -0,0 +1,201 @@
+#include "name.h"
+#include "hash.h"
+#include "core/memory.h"
+#include "platform/thread.h"
+
+#include <string.h>
+
+#define NAME_MIN_CAPACITY 256
+#define NAME_STRING_RESERVE (16 * 1024 * 1024)
+
+typedef struct {
+    uint64_t hash;
+    const char *str;
+    uint32_t len;
+} name_entry_t;
+
+struct name_system_t {
+    // asset loads intern from worker threads, strings get their own arena
+    // so they are only ever allocated under the lock
+    mutex_t lock;
+    arena_alloc_t strings;
+
+    // id -> entry, entry 0 is NAME_NONE
+    name_entry_t *entries;
+    uint32_t entry_count;
+    uint32_t entry_capacity;
+
+    // hash -> id, linear probing, 0 marks an empty slot
+    name_id_t *index;
+    uint32_t index_capacity;
+};
+
+static name_system_t *g_names = NULL;
+
+static bool index_grow(name_system_t *names, uint32_t capacity) {
+    name_id_t *index = WALLOC(sizeof(name_id_t) * capacity, MEM_ARRAY);
+    if (!index) return false;
+    memset(index, 0, sizeof(name_id_t) * capacity);
+
+    uint32_t mask = capacity - 1;
+    for (name_id_t id = 1; id < names->entry_count; ++id) {
+        uint32_t slot = (uint32_t)names->entries[id].hash & mask;
+        while (index[slot]) {
+            slot = (slot + 1) & mask;
+        }
+        index[slot] = id;
+    }
+
+    WFREE(names->index, sizeof(name_id_t) * names->index_capacity, MEM_ARRAY);
+    names->index = index;
+    names->index_capacity = capacity;
+    return true;
+}
+
+static bool entries_grow(name_system_t *names, uint32_t capacity) {
+    name_entry_t *entries = WALLOC(sizeof(name_entry_t) * capacity, MEM_ARRAY);
+    if (!entries) return false;
+
+    if (names->entries) {
+        memcpy(entries, names->entries,
+               sizeof(name_entry_t) * names->entry_count);
+    }
+    WFREE(names->entries, sizeof(name_entry_t) * names->entry_capacity,
+          MEM_ARRAY);
+    names->entries = entries;
+    names->entry_capacity = capacity;
+    return true;
+}
+
+// slot holding `str`, or the empty slot where it would go
+static uint32_t index_probe(const name_system_t *names, const char *str,
+                            uint32_t len, uint64_t hash) {
+    uint32_t mask = names->index_capacity - 1;
+    uint32_t slot = (uint32_t)hash & mask;
+
+    for (;;) {
+        name_id_t id = names->index[slot];
+        if (id == NAME_NONE) return slot;
+
+        const name_entry_t *e = &names->entries[id];
+        if (e->hash == hash && e->len == len && memcmp(e->str, str, len) == 0) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+}
+
+name_system_t *name_system_init(arena_alloc_t *arena) {
+    if (g_names != NULL) return g_names;
+
+    name_system_t *names = arena_alloc(arena, sizeof(name_system_t));
+    if (!names) return NULL;
+
+    memset(names, 0, sizeof(name_system_t));
+
+    if (!arena_create_ex(NAME_STRING_RESERVE, ARENA_VIRTUAL | ARENA_CHAINED,
+                         &names->strings)) {
+        LOG_ERROR("failed to reserve name strings");
+        return NULL;
+    }
+    if (!mutex_create(&names->lock)) return NULL;
+    if (!entries_grow(names, NAME_MIN_CAPACITY) ||
+        !index_grow(names, NAME_MIN_CAPACITY * 2)) {
+        LOG_ERROR("failed to allocate name table");
+        return NULL;
+    }
+
+    names->entries[0] = (name_entry_t){.hash = 0, .str = "", .len = 0};
+    names->entry_count = 1;
+
+    g_names = names;
+    LOG_INFO("name system initialized");
+    return names;
+}
+
+void name_system_kill(name_system_t *names) {
+    if (names) {
+        LOG_DEBUG("name system: %u names interned", names->entry_count - 1);
+        WFREE(names->index, sizeof(name_id_t) * names->index_capacity,
+              MEM_ARRAY);
+        WFREE(names->entries, sizeof(name_entry_t) * names->entry_capacity,
+              MEM_ARRAY);
+        mutex_kill(&names->lock);
+        arena_kill(&names->strings);
+        memset(names, 0, sizeof(name_system_t));
+    }
+    g_names = NULL;
+    LOG_INFO("name system kill");
+}
+
+static name_id_t intern_locked(name_system_t *names, const char *str,
+                               uint32_t len, uint64_t hash) {
+    uint32_t slot = index_probe(names, str, len, hash);
+    if (names->index[slot] != NAME_NONE) return names->index[slot];
+
+    // keep the index at most half full
+    if ((names->entry_count + 1) * 2 > names->index_capacity) {
+        if (!index_grow(names, names->index_capacity * 2)) return NAME_NONE;
+        slot = index_probe(names, str, len, hash);
+    }
+    if (names->entry_count == names->entry_capacity) {
+        if (!entries_grow(names, names->entry_capacity * 2)) return NAME_NONE;
+    }
+
+    // strings live as long as the system, so returned pointers stay valid
+    char *copy = arena_alloc_align(&names->strings, len + 1, 1);
+    if (!copy) {
+        LOG_ERROR("name arena exhausted interning '%s'", str);
+        return NAME_NONE;
+    }
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+
+    name_id_t id = names->entry_count++;
+    names->entries[id] = (name_entry_t){.hash = hash, .str = copy, .len = len};
+    names->index[slot] = id;
+    return id;
+}
+
+name_id_t name_intern_hashed(const char *str, uint32_t len, uint64_t hash) {
+    mutex_lock(&g_names->lock);
+    name_id_t id = intern_locked(g_names, str, len, hash);
+    mutex_unlock(&g_names->lock);
+    return id;
+}
+
+name_id_t name_intern(const char *str) {
+    if (!str || !*str) return NAME_NONE;
+
+    uint32_t len = (uint32_t)strlen(str);
+    return name_intern_hashed(str, len, hash_bytes(str, len));
+}
+
+name_id_t name_find_hashed(const char *str, uint32_t len, uint64_t hash) {
+    mutex_lock(&g_names->lock);
+    name_id_t id = g_names->index[index_probe(g_names, str, len, hash)];
+    mutex_unlock(&g_names->lock);
+    return id;
+}
+
+name_id_t name_find(const char *str) {
+    if (!str || !*str) return NAME_NONE;
+
+    uint32_t len = (uint32_t)strlen(str);
+    return name_find_hashed(str, len, hash_bytes(str, len));
+}
+
+const char *name_str(name_id_t id) {
+    if (!g_names) return "<invalid name>";
+
+    // the entry array may be reallocated by a concurrent intern
+    mutex_lock(&g_names->lock);
+    const char *str = id < g_names->entry_count ? g_names->entries[id].str
+                                                : "<invalid name>";
+    mutex_unlock(&g_names->lock);
+    return str;
+}
+
+uint32_t name_count(void) {
+    return g_names ? g_names->entry_count - 1 : 0;
+}
@@ -0,0 +1,32 @@
+#ifndef NAME_H
+#define NAME_H
+
+#include "core/define.h"
+#include "core/arena.h"
+
+// Interned strings. Every distinct string gets a stable 32-bit id for the
+// lifetime of the name system, so resources can be keyed and compared by
+// integer. Id 0 is reserved for "no name".
+typedef uint32_t name_id_t;
+
+#define NAME_NONE ((name_id_t)0)
+
+typedef struct name_system_t name_system_t;
+
+name_system_t *name_system_init(arena_alloc_t *arena);
+void name_system_kill(name_system_t *names);
+
+name_id_t name_intern(const char *str);
+name_id_t name_intern_hashed(const char *str, uint32_t len, uint64_t hash);
+
+// lookup only, returns NAME_NONE for strings never interned
+name_id_t name_find(const char *str);
+name_id_t name_find_hashed(const char *str, uint32_t len, uint64_t hash);
+
+// reverse map, for logs and debug views
+const char *name_str(name_id_t id);
+uint32_t name_count(void);
+
+#define NAME(str) name_intern(str)
+
+#endif // NAME_H
@@ -0,0 +1,135 @@
+#ifndef SPARSE_SET_H
+#define SPARSE_SET_H
+
+#include "core/define.h"
+#include "core/memory.h"
+
+#include <string.h>
+
+// Sparse set keyed by small integer ids (entity handles). Values are packed
+// in `values[0..count)` so systems iterate them densely, while lookup by id
+// goes through the sparse array in O(1). Removal swaps the last element in.
+//
+//   SPARSE_SET_DEFINE(transform_set, mat4)
+//   transform_set_t set;
+//   transform_set_init(&set, 1024);
+//   transform_set_insert(&set, entity, mat4_identity());
+
+#define SPARSE_SET_INVALID 0xFFFFFFFFu
+
+#define SPARSE_SET_DEFINE(name, type)                                          \
+typedef struct {                                                               \
+    uint32_t *sparse;                                                          \
+    uint32_t sparse_capacity;                                                  \
+    uint32_t *ids;                                                             \
+    type *values;                                                              \
+    uint32_t count;                                                            \
+    uint32_t capacity;                                                         \
+} name##_t;                                                                    \
+                                                                               \
+static inline bool name##_grow_sparse(name##_t *set, uint32_t id) {            \
+    uint32_t capacity = set->sparse_capacity ? set->sparse_capacity : 64;      \
+    while (capacity <= id) capacity *= 2;                                      \
+                                                                               \
+    uint32_t *sparse = WALLOC(sizeof(uint32_t) * capacity, MEM_DYNARRAY);      \
+    if (!sparse) return false;                                                 \
+                                                                               \
+    memset(sparse, 0xFF, sizeof(uint32_t) * capacity);                         \
+    if (set->sparse) {                                                         \
+        memcpy(sparse, set->sparse, sizeof(uint32_t) * set->sparse_capacity);  \
+        WFREE(set->sparse, sizeof(uint32_t) * set->sparse_capacity,            \
+              MEM_DYNARRAY);                                                   \
+    }                                                                          \
+    set->sparse = sparse;                                                      \
+    set->sparse_capacity = capacity;                                           \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+static inline bool name##_grow_dense(name##_t *set) {                          \
+    uint32_t capacity = set->capacity ? set->capacity * 2 : 64;                \
+    uint32_t *ids = WALLOC(sizeof(uint32_t) * capacity, MEM_DYNARRAY);         \
+    type *values = WALLOC(sizeof(type) * capacity, MEM_DYNARRAY);              \
+    if (!ids || !values) {                                                     \
+        WFREE(ids, sizeof(uint32_t) * capacity, MEM_DYNARRAY);                 \
+        WFREE(values, sizeof(type) * capacity, MEM_DYNARRAY);                  \
+        return false;                                                          \
+    }                                                                          \
+                                                                               \
+    if (set->count) {                                                          \
+        memcpy(ids, set->ids, sizeof(uint32_t) * set->count);                  \
+        memcpy(values, set->values, sizeof(type) * set->count);                \
+    }                                                                          \
+    WFREE(set->ids, sizeof(uint32_t) * set->capacity, MEM_DYNARRAY);           \
+    WFREE(set->values, sizeof(type) * set->capacity, MEM_DYNARRAY);            \
+    set->ids = ids;                                                            \
+    set->values = values;                                                      \
+    set->capacity = capacity;                                                  \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+static inline bool name##_init(name##_t *set, uint32_t max_id) {               \
+    memset(set, 0, sizeof(*set));                                              \
+    return name##_grow_sparse(set, max_id ? max_id - 1 : 0);                   \
+}                                                                              \
+                                                                               \
+static inline void name##_kill(name##_t *set) {                                \
+    WFREE(set->sparse, sizeof(uint32_t) * set->sparse_capacity,                \
+          MEM_DYNARRAY);                                                       \
+    WFREE(set->ids, sizeof(uint32_t) * set->capacity, MEM_DYNARRAY);           \
+    WFREE(set->values, sizeof(type) * set->capacity, MEM_DYNARRAY);            \
+    memset(set, 0, sizeof(*set));                                              \
+}                                                                              \
+                                                                               \
+static INL bool name##_has(const name##_t *set, uint32_t id) {                 \
+    return id < set->sparse_capacity &&                                        \
+           set->sparse[id] != SPARSE_SET_INVALID;                              \
+}                                                                              \
+                                                                               \
+static INL type *name##_get(name##_t *set, uint32_t id) {                      \
+    if (!name##_has(set, id)) return NULL;                                     \
+    return &set->values[set->sparse[id]];                                      \
+}                                                                              \
+                                                                               \
+static inline type *name##_insert(name##_t *set, uint32_t id, type value) {    \
+    type *found = name##_get(set, id);                                         \
+    if (found) {                                                               \
+        *found = value;                                                        \
+        return found;                                                          \
+    }                                                                          \
+                                                                               \
+    if (id >= set->sparse_capacity && !name##_grow_sparse(set, id)) {          \
+        return NULL;                                                           \
+    }                                                                          \
+    if (set->count == set->capacity && !name##_grow_dense(set)) {              \
+        return NULL;                                                           \
+    }                                                                          \
+                                                                               \
+    uint32_t index = set->count++;                                             \
+    set->sparse[id] = index;                                                   \
+    set->ids[index] = id;                                                      \
+    set->values[index] = value;                                                \
+    return &set->values[index];                                                \
+}                                                                              \
+                                                                               \
+static inline bool name##_remove(name##_t *set, uint32_t id) {                 \
+    if (!name##_has(set, id)) return false;                                    \
+                                                                               \
+    uint32_t index = set->sparse[id];                                          \
+    uint32_t last = --set->count;                                              \
+    if (index != last) {                                                       \
+        set->ids[index] = set->ids[last];                                      \
+        set->values[index] = set->values[last];                                \
+        set->sparse[set->ids[index]] = index;                                  \
+    }                                                                          \
+    set->sparse[id] = SPARSE_SET_INVALID;                                      \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+static INL void name##_clear(name##_t *set) {                                  \
+    for (uint32_t i = 0; i < set->count; ++i) {                                \
+        set->sparse[set->ids[i]] = SPARSE_SET_INVALID;                         \
+    }                                                                          \
+    set->count = 0;                                                            \
+}
+
+#endif // SPARSE_SET_H
@@ -36,12 +36,14 @@
 #    define ALIGN(n) __attribute__((aligned(n)))
 #    define LIKELY(x) __builtin_expect(!!(x), 1)
 #    define UNLIKELY(x) __builtin_expect(!!(x), 0)
+#    define THREAD_LOCAL __thread
 #elif defined(_MSC_VER)
 #    define INL __forceinline
 #    define NOINL __declspec(noinline)
 #    define ALIGN(n) __declspec(align(n))
 #    define LIKELY(x) (x)
 #    define UNLIKELY(x) (x)
+#    define THREAD_LOCAL __declspec(thread)
 #endif
 
 #ifdef DEBUG
@@ -1,9 +1,14 @@
 #include "event.h"
+#include "platform/window.h"
+#include "platform/thread.h"
 
 #include <stdlib.h>
 #include <string.h>
 
 #define MAX_MSG_CODE (EVENT_MAX + 1)
+#define EVENT_QUEUE_SIZE 1024 // power of two
+#define MAX_DISPATCH_PASS 4
+#define EVENT_ASYNC_SIZE 1024 // power of two
 
 typedef struct {
     on_event callback;
@@ -16,17 +21,70 @@ typedef struct {
     uint64_t capacity;
 } ev_entry;
 
+typedef struct {
+    event_t ev;
+    void *sender;
+} ev_queued;
+
+// bounded MPSC cell: `seq == pos` free for the producer claiming pos,
+// `seq == pos + 1` filled and ready for the consumer
+typedef struct {
+    uint32_t seq;
+    ev_queued item;
+} ev_cell;
+
 struct event_system_t {
     ev_entry reg[MAX_MSG_CODE];
+    uint8_t mode[MAX_MSG_CODE];
+    uint8_t coalesce[MAX_MSG_CODE];
     arena_alloc_t *arena;
+
+    double start_time;
+
+    event_observer observer;
+    void *observer_user;
+    event_waker waker;
+    void *waker_user;
+    uint32_t depth; // > 0 while handlers run
+
+    // ring of queued events, head/tail run freely and wrap by mask
+    ev_queued *queue;
+    uint32_t *order; // dispatch scratch, queue offsets sorted by type
+    uint32_t head;
+    uint32_t tail;
+    uint32_t overflow;
+
+    // newest queued position + 1 per type, 0 when none. Positions below
+    // `sealed` are being dispatched and can no longer absorb merges
+    uint32_t last_pos[MAX_MSG_CODE];
+    uint32_t sealed;
+    uint32_t merged;
+    event_frame_stats_t stats;
+
+    // producers race on async_tail, only the main thread moves async_head
+    ev_cell *async;
+    ALIGN(64) uint32_t async_tail;
+    ALIGN(64) uint32_t async_head;
+    uint32_t async_dropped;
 };
 
 event_system_t *event_system_init(arena_alloc_t *arena) {
-    event_system_t *event = arena_alloc(arena, sizeof(event_system_t));
+    event_system_t *event =
+        arena_alloc_align(arena, sizeof(event_system_t), 64);
     if (!event) return NULL;
 
     memset(event, 0, sizeof(event_system_t));
     event->arena = arena;
+    event->start_time = get_abs_time();
+
+    event->queue = arena_alloc(arena, sizeof(ev_queued) * EVENT_QUEUE_SIZE);
+    event->order = arena_alloc(arena, sizeof(uint32_t) * EVENT_QUEUE_SIZE);
+    event->async = arena_alloc(arena, sizeof(ev_cell) * EVENT_ASYNC_SIZE);
+    if (!event->queue || !event->order || !event->async) return NULL;
+
+    for (uint32_t i = 0; i < EVENT_ASYNC_SIZE; ++i) {
+        event->async[i].seq = i;
+    }
 
     LOG_INFO("event system initialized");
     return event;
@@ -34,6 +92,13 @@ event_system_t *event_system_init(arena_alloc_t *arena) {
 
 void event_system_kill(event_system_t *event) {
     if (event) {
+        if (event->overflow) {
+            LOG_WARN("event queue overflowed %u times", event->overflow);
+        }
+        if (event->async_dropped) {
+            LOG_WARN("async event ring dropped %u events",
+                     event->async_dropped);
+        }
         memset(event, 0, sizeof(event_system_t));
     }
     LOG_INFO("event system kill");
@@ -89,18 +154,212 @@ bool event_unreg(event_system_t *event, uint32_t type, on_event handler,
     return false;
 }
 
-bool event_push(event_system_t *event, uint32_t type, const event_t *ev,
-                void *sender) {
-    if (type >= MAX_MSG_CODE) return false;
-
-    // Process immediately (no queue) or add to your arena-based queue
+static void dispatch(event_system_t *event, uint32_t type, event_t *ev,
+                     void *sender) {
     ev_entry *entry = &event->reg[type];
+    event->depth++;
     for (size_t i = 0; i < entry->count; i++) {
-        if (!entry->handlers[i].callback(event, type, (event_t *)ev, sender,
+        if (!entry->handlers[i].callback(event, type, ev, sender,
                                          entry->handlers[i].recipient)) {
             break; // Stop propagation if handler returns false
         }
     }
+    event->depth--;
+}
+
+static INL uint32_t event_ticks(const event_system_t *event) {
+    return (uint32_t)((get_abs_time() - event->start_time) * 1000.0);
+}
+
+// fold `ev` into the pending queued event of its type, if the policy allows
+static bool coalesce(event_system_t *event, const event_t *ev, void *sender) {
+    uint32_t type = ev->type;
+    if (event->coalesce[type] == EVENT_COALESCE_NONE) return false;
+
+    uint32_t pos = event->last_pos[type] - 1;
+    if (event->last_pos[type] == 0 ||
+        pos - event->sealed >= event->tail - event->sealed) {
+        return false;
+    }
+
+    ev_queued *pending = &event->queue[pos & (EVENT_QUEUE_SIZE - 1)];
+    switch (event->coalesce[type]) {
+        case EVENT_COALESCE_ACCUMULATE: {
+            event_t *p = &pending->ev;
+            int32_t dx = p->data.mouse_move.dx + ev->data.mouse_move.dx;
+            int32_t dy = p->data.mouse_move.dy + ev->data.mouse_move.dy;
+            p->data.mouse_move.dx = (int16_t)(CLAMP(dx, INT16_MIN, INT16_MAX));
+            p->data.mouse_move.dy = (int16_t)(CLAMP(dy, INT16_MIN, INT16_MAX));
+            p->data.mouse_move.x = ev->data.mouse_move.x;
+            p->data.mouse_move.y = ev->data.mouse_move.y;
+            p->ticks = ev->ticks;
+        } break;
+
+        case EVENT_COALESCE_LAST: {
+            pending->ev = *ev;
+            pending->sender = sender;
+        } break;
+
+        case EVENT_COALESCE_REPEAT: {
+            if (!ev->data.keys.is_repeat || !pending->ev.data.keys.is_repeat ||
+                ev->data.keys.keycode != pending->ev.data.keys.keycode) {
+                return false;
+            }
+            pending->ev.ticks = ev->ticks;
+        } break;
+
+        default: return false;
+    }
+
+    event->merged++;
+    return true;
+}
+
+static void push_stamped(event_system_t *event, event_t stamped,
+                         void *sender) {
+    uint32_t type = stamped.type;
+    if (event->mode[type] == EVENT_MODE_QUEUED) {
+        if (coalesce(event, &stamped, sender)) return;
+
+        if (event->tail - event->head < EVENT_QUEUE_SIZE) {
+            uint32_t index = event->tail & (EVENT_QUEUE_SIZE - 1);
+            ev_queued *slot = &event->queue[index];
+            slot->ev = stamped;
+            slot->sender = sender;
+            event->last_pos[type] = ++event->tail;
+            return;
+        }
+        // full: deliver now rather than lose it
+        event->overflow++;
+    }
+
+    dispatch(event, type, &stamped, sender);
+}
+
+bool event_push(event_system_t *event, uint32_t type, const event_t *ev,
+                void *sender) {
+    if (type >= MAX_MSG_CODE) return false;
+
+    event_t stamped = *ev;
+    stamped.type = type;
+    stamped.ticks = event_ticks(event);
+    if (event->observer && event->depth == 0) {
+        event->observer(&stamped, event->observer_user);
+    }
+    push_stamped(event, stamped, sender);
+    return true;
+}
+
+bool event_post_async(event_system_t *event, uint32_t type, const event_t *ev,
+                      void *sender) {
+    if (type >= MAX_MSG_CODE) return false;
+
+    uint32_t pos = ATOMIC_LOAD(&event->async_tail);
+    ev_cell *cell;
+    for (;;) {
+        cell = &event->async[pos & (EVENT_ASYNC_SIZE - 1)];
+        int32_t diff = (int32_t)(ATOMIC_LOAD_ACQ(&cell->seq) - pos);
+        if (diff == 0) {
+            if (ATOMIC_CAS(&event->async_tail, &pos, pos + 1)) break;
+        } else if (diff < 0) {
+            ATOMIC_ADD(&event->async_dropped, 1);
+            return false;
+        } else {
+            pos = ATOMIC_LOAD(&event->async_tail);
+        }
+    }
 
+    cell->item.ev = *ev;
+    cell->item.ev.type = type;
+    cell->item.ev.ticks = event_ticks(event);
+    cell->item.sender = sender;
+    ATOMIC_STORE_REL(&cell->seq, pos + 1);
+    if (event->waker) event->waker(event->waker_user);
     return true;
 }
+
+void event_set_waker(event_system_t *event, event_waker waker, void *user) {
+    event->waker = waker;
+    event->waker_user = user;
+}
+
+// main thread only
+static void drain_async(event_system_t *event) {
+    for (;;) {
+        uint32_t pos = event->async_head;
+        ev_cell *cell = &event->async[pos & (EVENT_ASYNC_SIZE - 1)];
+        if (ATOMIC_LOAD_ACQ(&cell->seq) != pos + 1) break;
+
+        ev_queued item = cell->item;
+        ATOMIC_STORE_REL(&cell->seq, pos + EVENT_ASYNC_SIZE);
+        event->async_head = pos + 1;
+
+        push_stamped(event, item.ev, item.sender);
+    }
+}
+
+void event_set_mode(event_system_t *event, uint32_t type, event_mode_t mode) {
+    if (type < MAX_MSG_CODE) event->mode[type] = (uint8_t)mode;
+}
+
+void event_set_coalesce(event_system_t *event, uint32_t type,
+                        event_coalesce_t policy) {
+    if (type < MAX_MSG_CODE) event->coalesce[type] = (uint8_t)policy;
+}
+
+event_frame_stats_t event_frame_stats(const event_system_t *event) {
+    return event->stats;
+}
+
+void event_set_observer(event_system_t *event, event_observer observer,
+                        void *user) {
+    event->observer = observer;
+    event->observer_user = user;
+}
+
+uint32_t event_dispatch_all(event_system_t *event) {
+    const uint32_t mask = EVENT_QUEUE_SIZE - 1;
+    uint32_t dispatched = 0;
+
+    // worker posts join the normal path, immediate types dispatch here
+    drain_async(event);
+
+    // handlers may queue more events, those go out in the next pass
+    for (uint32_t pass = 0; pass < MAX_DISPATCH_PASS; ++pass) {
+        uint32_t head = event->head;
+        uint32_t count = event->tail - head;
+        if (count == 0) break;
+
+        // counting sort by type, stable so each type keeps push order
+        uint32_t offset[MAX_MSG_CODE];
+        memset(offset, 0, sizeof(offset));
+        for (uint32_t i = 0; i < count; ++i) {
+            offset[event->queue[(head + i) & mask].ev.type]++;
+        }
+        uint32_t sum = 0;
+        for (uint32_t t = 0; t < MAX_MSG_CODE; ++t) {
+            uint32_t n = offset[t];
+            offset[t] = sum;
+            sum += n;
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t type = event->queue[(head + i) & mask].ev.type;
+            event->order[offset[type]++] = (head + i) & mask;
+        }
+
+        // slots stay valid until head moves past them
+        event->sealed = head + count;
+        for (uint32_t i = 0; i < count; ++i) {
+            ev_queued *q = &event->queue[event->order[i]];
+            dispatch(event, q->ev.type, &q->ev, q->sender);
+        }
+        event->head = head + count;
+        dispatched += count;
+    }
+
+    event->stats.dispatched = dispatched;
+    event->stats.merged = event->merged;
+    event->stats.merged_total += event->merged;
+    event->merged = 0;
+    return dispatched;
+}
@@ -17,13 +17,34 @@ typedef enum {
     EVENT_MOUSE_RELEASE = 0x08,
     EVENT_MOUSE_MOVE = 0x09,
     EVENT_MOUSE_WHEEL = 0x0A,
+    EVENT_MOUSE_RAW = 0x0B, // unaccelerated dx/dy, x/y is the cursor
 
     EVENT_MAX = 0xFF
 } event_type_t;
 
+typedef enum {
+    EVENT_MODE_IMMEDIATE = 0, // handlers run inside event_push
+    EVENT_MODE_QUEUED = 1     // held until event_dispatch_all
+} event_mode_t;
+
+// How a queued event merges with the pending one of the same type that has
+// not been dispatched yet. Only applies to EVENT_MODE_QUEUED types.
+typedef enum {
+    EVENT_COALESCE_NONE = 0,   // every event is delivered
+    EVENT_COALESCE_ACCUMULATE, // mouse move: latest x/y, dx/dy summed
+    EVENT_COALESCE_LAST,       // only the newest survives (resize)
+    EVENT_COALESCE_REPEAT      // key repeats of the same key collapse
+} event_coalesce_t;
+
+typedef struct {
+    uint32_t dispatched; // delivered by the last event_dispatch_all
+    uint32_t merged;     // folded into a pending event since the one before
+    uint64_t merged_total;
+} event_frame_stats_t;
+
 typedef struct {
     uint32_t type;
-    uint32_t ticks;
+    uint32_t ticks; // milliseconds since event_system_init, set on push
 
     union {
         struct {
@@ -68,6 +89,9 @@ typedef struct {
 typedef struct event_system_t event_system_t;
 typedef bool (*on_event)(event_system_t *event, uint32_t type, event_t *ev,
                          void *sender, void *recipient);
+// sees every event pushed from outside a handler, already stamped
+typedef void (*event_observer)(const event_t *ev, void *user);
+typedef void (*event_waker)(void *user);
 
 // initializer state
 event_system_t *event_system_init(arena_alloc_t *arena);
@@ -81,4 +105,29 @@ bool event_unreg(event_system_t *event, uint32_t type, on_event handler,
 bool event_push(event_system_t *event, uint32_t type, const event_t *ev,
                 void *sender);
 
+// Queued types are buffered in a ring and delivered by event_dispatch_all,
+// grouped by type and in push order within a type. Every type starts out
+// immediate.
+void event_set_mode(event_system_t *event, uint32_t type, event_mode_t mode);
+void event_set_coalesce(event_system_t *event, uint32_t type,
+                        event_coalesce_t policy);
+uint32_t event_dispatch_all(event_system_t *event);
+event_frame_stats_t event_frame_stats(const event_system_t *event);
+
+// One observer (the replay recorder). Events raised by handlers and async
+// posts are not observed, they are consequences of the observed ones.
+void event_set_observer(event_system_t *event, event_observer observer,
+                        void *user);
+
+// Thread-safe, lock-free post for worker threads. The event is held in a
+// bounded MPSC ring until the main thread's next event_dispatch_all, which
+// feeds it through the type's normal mode. Returns false when the ring is
+// full and the event was dropped.
+bool event_post_async(event_system_t *event, uint32_t type, const event_t *ev,
+                      void *sender);
+// Called on the posting thread after every async post that made it into the
+// ring, so a main loop blocked waiting for input comes back to dispatch it.
+// Set it before any worker starts posting.
+void event_set_waker(event_system_t *event, event_waker waker, void *user);
+
 #endif // EVENT_H
@@ -3,30 +3,72 @@
 
 #include <string.h>
 
+#if defined(__AVX2__) || defined(__SSE2__)
+#    include <immintrin.h>
+#endif
+
 #define MAX_KEYS 256
-#define MAX_BUTTONS 8
 
+// one bit per key, a whole keyboard is 32 bytes
 typedef struct {
-    bool keys[MAX_KEYS];
-} keyboard_state;
+    uint64_t bits[MAX_KEYS / 64];
+} key_bits_t;
 
 typedef struct {
     int16_t pos_x;
     int16_t pos_y;
     uint8_t wheel_delta;
-    uint8_t buttons[MAX_BUTTONS];
+    uint8_t buttons; // bit per input_button_t
 } mouse_state;
 
 struct input_system_t {
     arena_alloc_t *arena;
-    keyboard_state kbd_curr;
-    keyboard_state kbd_prev;
+
+    key_bits_t kbd_curr;
+    key_bits_t kbd_prev;
+
     mouse_state mouse_curr;
     mouse_state mouse_prev;
 };
 
 static input_system_t *g_ip = NULL;
 
+static INL bool bit_get(const key_bits_t *set, uint32_t key) {
+    return (set->bits[key >> 6] >> (key & 63)) & 1;
+}
+
+static INL void bit_put(key_bits_t *set, uint32_t key, bool value) {
+    uint64_t mask = 1ull << (key & 63);
+    if (value) {
+        set->bits[key >> 6] |= mask;
+    } else {
+        set->bits[key >> 6] &= ~mask;
+    }
+}
+
+// down = curr & ~prev, up = prev & ~curr over all 256 keys at once
+static INL void bits_edges(const key_bits_t *curr, const key_bits_t *prev,
+                           key_bits_t *down, key_bits_t *up) {
+#if defined(__AVX2__)
+    __m256i c = _mm256_loadu_si256((const __m256i *)curr->bits);
+    __m256i p = _mm256_loadu_si256((const __m256i *)prev->bits);
+    _mm256_storeu_si256((__m256i *)down->bits, _mm256_andnot_si256(p, c));
+    _mm256_storeu_si256((__m256i *)up->bits, _mm256_andnot_si256(c, p));
+#elif defined(__SSE2__)
+    for (uint32_t i = 0; i < 4; i += 2) {
+        __m128i c = _mm_loadu_si128((const __m128i *)&curr->bits[i]);
+        __m128i p = _mm_loadu_si128((const __m128i *)&prev->bits[i]);
+        _mm_storeu_si128((__m128i *)&down->bits[i], _mm_andnot_si128(p, c));
+        _mm_storeu_si128((__m128i *)&up->bits[i], _mm_andnot_si128(c, p));
+    }
+#else
+    for (uint32_t i = 0; i < 4; ++i) {
+        down->bits[i] = curr->bits[i] & ~prev->bits[i];
+        up->bits[i] = prev->bits[i] & ~curr->bits[i];
+    }
+#endif
+}
+
 input_system_t *input_system_init(arena_alloc_t *arena) {
     input_system_t *input = arena_alloc(arena, sizeof(input_system_t));
     if (!input) return NULL;
@@ -41,18 +83,15 @@ input_system_t *input_system_init(arena_alloc_t *arena) {
 
 void input_system_update(input_system_t *input, float delta,
                          arena_alloc_t *frame_arena) {
+    (void)input;
     (void)delta;
     (void)frame_arena;
+}
 
-    for (uint32_t i = 0; i < MAX_KEYS; ++i) {
-        input->kbd_prev.keys[i] = input->kbd_curr.keys[i];
-    }
-    for (uint32_t i = 0; i < MAX_BUTTONS; ++i) {
-        input->mouse_prev.buttons[i] = input->mouse_curr.buttons[i];
-    }
-
-    input->mouse_prev.pos_x = input->mouse_curr.pos_x;
-    input->mouse_prev.pos_y = input->mouse_curr.pos_y;
+void input_frame_end(input_system_t *input) {
+    // snapshot is a 32 byte copy for the keyboard
+    input->kbd_prev = input->kbd_curr;
+    input->mouse_prev = input->mouse_curr;
     input->mouse_curr.wheel_delta = 0;
 }
 
@@ -63,20 +102,35 @@ void input_system_kill(input_system_t *input) {
 
 void input_process_key(input_system_t *input, event_system_t *event,
                        input_keys_t key, bool is_press) {
-    if (input->kbd_curr.keys[key] != is_press) {
-        input->kbd_curr.keys[key] = is_press;
+    if (bit_get(&input->kbd_curr, key) != is_press) {
+        bit_put(&input->kbd_curr, key, is_press);
 
-        event_t ev;
+        event_t ev = {0};
         ev.data.keys.keycode = (uint16_t)key;
         event_push(event, is_press ? EVENT_KEY_PRESS : EVENT_KEY_RELEASE, &ev,
                    NULL);
     }
 }
 
+void input_process_key_repeat(input_system_t *input, event_system_t *event,
+                              input_keys_t key) {
+    if (!bit_get(&input->kbd_curr, key)) return;
+
+    event_t ev = {0};
+    ev.data.keys.keycode = (uint16_t)key;
+    ev.data.keys.is_repeat = 1;
+    event_push(event, EVENT_KEY_PRESS, &ev, NULL);
+}
+
 void input_process_button(input_system_t *input, event_system_t *event,
                           input_button_t button, bool is_press) {
-    if (input->mouse_curr.buttons[button] != is_press) {
-        input->mouse_curr.buttons[button] = is_press;
+    uint8_t mask = (uint8_t)(1u << button);
+    if (((input->mouse_curr.buttons & mask) != 0) != is_press) {
+        if (is_press) {
+            input->mouse_curr.buttons |= mask;
+        } else {
+            input->mouse_curr.buttons &= (uint8_t)~mask;
+        }
 
         event_t ev;
         ev.data.mouse_button.button = (uint8_t)button;
@@ -88,16 +142,31 @@ void input_process_button(input_system_t *input, event_system_t *event,
 void input_process_mouse_move(input_system_t *input, event_system_t *event,
                               int16_t pos_x, int16_t pos_y) {
     if (input->mouse_curr.pos_x != pos_x || input->mouse_curr.pos_y != pos_y) {
+        event_t ev = {0};
+        ev.data.mouse_move.dx = (int16_t)(pos_x - input->mouse_curr.pos_x);
+        ev.data.mouse_move.dy = (int16_t)(pos_y - input->mouse_curr.pos_y);
+
         input->mouse_curr.pos_x = pos_x;
         input->mouse_curr.pos_y = pos_y;
 
-        event_t ev;
         ev.data.mouse_move.x = pos_x;
         ev.data.mouse_move.y = pos_y;
         event_push(event, EVENT_MOUSE_MOVE, &ev, NULL);
     }
 }
 
+void input_process_mouse_raw(input_system_t *input, event_system_t *event,
+                             int16_t dx, int16_t dy) {
+    if (dx == 0 && dy == 0) return;
+
+    event_t ev = {0};
+    ev.data.mouse_move.dx = dx;
+    ev.data.mouse_move.dy = dy;
+    ev.data.mouse_move.x = input->mouse_curr.pos_x;
+    ev.data.mouse_move.y = input->mouse_curr.pos_y;
+    event_push(event, EVENT_MOUSE_RAW, &ev, NULL);
+}
+
 void input_process_mouse_wheel(input_system_t *input, event_system_t *event,
                                int8_t delta_z) {
     input->mouse_curr.wheel_delta = (uint8_t)delta_z;
@@ -109,33 +178,69 @@ void input_process_mouse_wheel(input_system_t *input, event_system_t *event,
     }
 }
 
-bool key_press(input_keys_t key) { return g_ip->kbd_curr.keys[key] == true; }
+bool key_press(input_keys_t key) { return bit_get(&g_ip->kbd_curr, key); }
 
-bool key_release(input_keys_t key) { return g_ip->kbd_curr.keys[key] == false; }
+bool key_release(input_keys_t key) { return !bit_get(&g_ip->kbd_curr, key); }
 
 bool key_was_pressed(input_keys_t key) {
-    return g_ip->kbd_prev.keys[key] == true;
+    return bit_get(&g_ip->kbd_prev, key);
 }
 
 bool key_was_released(input_keys_t key) {
-    return g_ip->kbd_prev.keys[key] == false;
+    return !bit_get(&g_ip->kbd_prev, key);
+}
+
+bool key_went_down(input_keys_t key) {
+    return bit_get(&g_ip->kbd_curr, key) && !bit_get(&g_ip->kbd_prev, key);
+}
+
+bool key_went_up(input_keys_t key) {
+    return !bit_get(&g_ip->kbd_curr, key) && bit_get(&g_ip->kbd_prev, key);
+}
+
+uint32_t keys_changed(input_keys_t *out_keys, bool *out_down, uint32_t max) {
+    key_bits_t down, up;
+    bits_edges(&g_ip->kbd_curr, &g_ip->kbd_prev, &down, &up);
+
+    uint32_t count = 0;
+    for (uint32_t w = 0; w < MAX_KEYS / 64 && count < max; ++w) {
+        uint64_t changed = down.bits[w] | up.bits[w];
+        while (changed && count < max) {
+            uint32_t bit = (uint32_t)__builtin_ctzll(changed);
+            out_keys[count] = (input_keys_t)(w * 64 + bit);
+            if (out_down) out_down[count] = (down.bits[w] >> bit) & 1;
+            count++;
+            changed &= changed - 1;
+        }
+    }
+    return count;
 }
 
 // mouse
 bool button_press(input_button_t button) {
-    return g_ip->mouse_curr.buttons[button] == true;
+    return (g_ip->mouse_curr.buttons >> button) & 1;
 }
 
 bool button_release(input_button_t button) {
-    return g_ip->mouse_curr.buttons[button] == false;
+    return !((g_ip->mouse_curr.buttons >> button) & 1);
 }
 
 bool button_was_pressed(input_button_t button) {
-    return g_ip->mouse_prev.buttons[button] == true;
+    return (g_ip->mouse_prev.buttons >> button) & 1;
 }
 
 bool button_was_released(input_button_t button) {
-    return g_ip->mouse_prev.buttons[button] == false;
+    return !((g_ip->mouse_prev.buttons >> button) & 1);
+}
+
+bool button_went_down(input_button_t button) {
+    const mouse_state *curr = &g_ip->mouse_curr;
+    return ((curr->buttons & ~g_ip->mouse_prev.buttons) >> button) & 1;
+}
+
+bool button_went_up(input_button_t button) {
+    const mouse_state *curr = &g_ip->mouse_curr;
+    return ((g_ip->mouse_prev.buttons & ~curr->buttons) >> button) & 1;
 }
 
 void get_mouse_pos(int32_t *pos_x, int32_t *pos_y) {
@@ -147,14 +147,24 @@ input_system_t *input_system_init(arena_alloc_t *arena);
 void input_system_update(input_system_t *input, float delta,
                          arena_alloc_t *frame_arena);
 void input_system_kill(input_system_t *input);
+// After the frame consumed its input: what was pumped so far becomes the
+// previous state and the wheel delta is cleared. Edge queries compare
+// against this snapshot, so it must not run between pump and game update.
+void input_frame_end(input_system_t *input);
 
 // runtime
 void input_process_key(input_system_t *input, event_system_t *event,
                        input_keys_t key, bool is_press);
+// auto-repeat while held, state is unchanged, a press with is_repeat is sent
+void input_process_key_repeat(input_system_t *input, event_system_t *event,
+                              input_keys_t key);
 void input_process_button(input_system_t *input, event_system_t *event,
                           input_button_t button, bool is_press);
 void input_process_mouse_move(input_system_t *input, event_system_t *event,
                               int16_t pos_x, int16_t pos_y);
+// device deltas straight from the mouse, the cursor position is unchanged
+void input_process_mouse_raw(input_system_t *input, event_system_t *event,
+                             int16_t dx, int16_t dy);
 void input_process_mouse_wheel(input_system_t *input, event_system_t *event,
                                int8_t delta_z);
 
@@ -163,12 +173,20 @@ bool key_press(input_keys_t key);
 bool key_release(input_keys_t key);
 bool key_was_pressed(input_keys_t key);
 bool key_was_released(input_keys_t key);
+// changed since the last input_frame_end
+bool key_went_down(input_keys_t key);
+bool key_went_up(input_keys_t key);
+// Every key that went down or up in one pass over the edge bitsets, in key
+// order. `out_down` (optional) tells which way. Returns the count written.
+uint32_t keys_changed(input_keys_t *out_keys, bool *out_down, uint32_t max);
 
 // mouse
 bool button_press(input_button_t button);
 bool button_release(input_button_t button);
 bool button_was_pressed(input_button_t button);
 bool button_was_released(input_button_t button);
+bool button_went_down(input_button_t button);
+bool button_went_up(input_button_t button);
 void get_mouse_pos(int32_t *pos_x, int32_t *pos_y);
 void get_mouse_prev_pos(int32_t *pos_x, int32_t *pos_y);
 
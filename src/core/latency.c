@@ -0,0 +1,119 @@
+#include "latency.h"
+#include "platform/window.h"
+
+#include <string.h>
+
+#define BUCKET_US 100 // histogram resolution
+#define BUCKET_COUNT 2500 // 0..250ms, anything above lands in the last one
+
+typedef struct {
+    uint32_t buckets[BUCKET_COUNT];
+    uint64_t samples;
+    double max;
+} latency_hist_t;
+
+struct latency_system_t {
+    arena_alloc_t *arena;
+
+    double pending;  // oldest input not yet picked up by a frame, 0 = none
+    double consumed; // oldest input of the frame being built, 0 = none
+    latency_hist_t hist[LATENCY_STAGE_MAX];
+};
+
+static latency_system_t *g_lat = NULL;
+
+static const char *stage_str[LATENCY_STAGE_MAX] = {"submit", "present"};
+
+static void hist_add(latency_hist_t *hist, double seconds) {
+    uint64_t bucket = (uint64_t)(seconds * 1e6) / BUCKET_US;
+    if (bucket >= BUCKET_COUNT) bucket = BUCKET_COUNT - 1;
+
+    hist->buckets[bucket]++;
+    hist->samples++;
+    hist->max = MAX(hist->max, seconds);
+}
+
+// upper edge of the bucket holding the `pct` percentile, in ms
+static float hist_percentile(const latency_hist_t *hist, double pct) {
+    uint64_t rank = (uint64_t)((double)hist->samples * pct + 0.5);
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            float edge = (float)((i + 1) * BUCKET_US) / 1000.0f;
+            return MIN(edge, (float)(hist->max * 1000.0));
+        }
+    }
+    return (float)(hist->max * 1000.0);
+}
+
+latency_system_t *latency_system_init(arena_alloc_t *arena) {
+    latency_system_t *lat = arena_alloc(arena, sizeof(latency_system_t));
+    if (!lat) return NULL;
+
+    memset(lat, 0, sizeof(latency_system_t));
+    lat->arena = arena;
+
+    g_lat = lat;
+    LOG_INFO("latency system initialized");
+    return lat;
+}
+
+void latency_system_kill(latency_system_t *lat) {
+    if (!lat) return;
+
+    for (uint32_t i = 0; i < LATENCY_STAGE_MAX; ++i) {
+        latency_stats_t s = latency_stats((latency_stage_t)i);
+        if (!s.samples) continue;
+        LOG_INFO("input to %s: %lu frames, p50 %.1fms, p95 %.1fms, "
+                 "p99 %.1fms, max %.1fms",
+                 stage_str[i], s.samples, s.p50, s.p95, s.p99, s.max);
+    }
+
+    memset(lat, 0, sizeof(latency_system_t));
+    g_lat = NULL;
+    LOG_INFO("latency system kill");
+}
+
+void latency_input(void) {
+    // only the oldest input of a frame matters, skip the clock otherwise
+    if (g_lat && g_lat->pending == 0.0) g_lat->pending = get_abs_time();
+}
+
+void latency_frame_begin(void) {
+    if (!g_lat || g_lat->pending == 0.0) return;
+
+    // a frame that never presented hands its input on to this one
+    if (g_lat->consumed == 0.0 || g_lat->pending < g_lat->consumed) {
+        g_lat->consumed = g_lat->pending;
+    }
+    g_lat->pending = 0.0;
+}
+
+void latency_mark(latency_stage_t stage) {
+    if (!g_lat || g_lat->consumed == 0.0) return;
+
+    hist_add(&g_lat->hist[stage], get_abs_time() - g_lat->consumed);
+    if (stage == LATENCY_PRESENT) g_lat->consumed = 0.0;
+}
+
+latency_stats_t latency_stats(latency_stage_t stage) {
+    latency_stats_t s = {0};
+    if (!g_lat) return s;
+
+    const latency_hist_t *hist = &g_lat->hist[stage];
+    s.samples = hist->samples;
+    if (!hist->samples) return s;
+
+    s.p50 = hist_percentile(hist, 0.50);
+    s.p95 = hist_percentile(hist, 0.95);
+    s.p99 = hist_percentile(hist, 0.99);
+    s.max = (float)(hist->max * 1000.0);
+    return s;
+}
+
+void latency_reset(void) {
+    if (g_lat) memset(g_lat->hist, 0, sizeof(g_lat->hist));
+}
@@ -0,0 +1,35 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "define.h"
+#include "arena.h"
+
+// Input-to-photon latency. The platform pump marks the moment it receives
+// an input event, the frame that consumes it carries that time to the
+// renderer, which marks submit and present. Every frame with input adds one
+// sample per stage, measured from its oldest input.
+typedef enum {
+    LATENCY_SUBMIT = 0, // vkQueueSubmit returned
+    LATENCY_PRESENT,    // vkQueuePresentKHR returned
+    LATENCY_STAGE_MAX
+} latency_stage_t;
+
+typedef struct {
+    uint64_t samples;
+    float p50, p95, p99, max; // milliseconds
+} latency_stats_t;
+
+typedef struct latency_system_t latency_system_t;
+
+latency_system_t *latency_system_init(arena_alloc_t *arena);
+void latency_system_kill(latency_system_t *lat);
+
+// runtime, no-ops before init
+void latency_input(void);
+void latency_frame_begin(void);
+void latency_mark(latency_stage_t stage);
+
+latency_stats_t latency_stats(latency_stage_t stage);
+void latency_reset(void);
+
+#endif // LATENCY_H
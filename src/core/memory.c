@@ -1,4 +1,8 @@
 #include "memory.h"
+#include "tlsf.h"
+#include "platform/vmem.h"
+#include "platform/thread.h"
+#include "platform/window.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -6,6 +10,14 @@
 
 #define MAX_ALLOC_TRACK 4096
 #define BUFFER_SIZE 8192
+#define TRACK_LOAD_NUM 7
+#define TRACK_LOAD_DEN 10
+
+#define CACHE_CLASS_MIN_LOG2 4
+#define CACHE_CLASS_COUNT 5
+#define CACHE_SMALL_MAX (1u << (CACHE_CLASS_MIN_LOG2 + CACHE_CLASS_COUNT - 1))
+#define CACHE_DEPTH 64
+#define CACHE_FOLD_OPS 256
 
 static const char *tag_str[MEM_MAX_TAG] = {"MEM_UNKNOWN", "MEM_ENGINE",
                                            "MEM_GAME",    "MEM_ARENA",
@@ -20,6 +32,281 @@ struct status {
     uint64_t tag_allocation[MEM_MAX_TAG];
 };
 
+static struct status g_counter = {0};
+static uint64_t g_budget[MEM_MAX_TAG];
+
+// optional engine heap, blocks outside its range came from the system
+static tlsf_t *g_heap = NULL;
+static void *g_heap_memory = NULL;
+static uint64_t g_heap_size = 0;
+static uint64_t g_heap_fallback = 0;
+
+// Small blocks freed by a thread are parked in that thread's cache and handed
+// back to the next same-class WALLOC on it without touching the heap lock.
+// Counters of tags without a budget are kept here too and folded into
+// g_counter every CACHE_FOLD_OPS calls, so the fast path writes no shared
+// cache line.
+typedef struct {
+    void *head[CACHE_CLASS_COUNT];
+    uint32_t count[CACHE_CLASS_COUNT];
+
+    int64_t tag_allocation[MEM_MAX_TAG];
+    int64_t tag_alloc_count[MEM_MAX_TAG];
+    uint64_t total_allocated;
+    uint64_t hits;
+    uint32_t pending;
+} thread_cache_t;
+
+static THREAD_LOCAL thread_cache_t t_cache;
+
+static mutex_t g_heap_lock;
+static uint64_t g_lock_acquired = 0;
+static uint64_t g_lock_contended = 0;
+static uint64_t g_cache_hits = 0;
+
+static void counters_fold(void) {
+    for (uint32_t i = 0; i < MEM_MAX_TAG; ++i) {
+        if (t_cache.tag_allocation[i]) {
+            ATOMIC_ADD(&g_counter.tag_allocation[i],
+                       (uint64_t)t_cache.tag_allocation[i]);
+            t_cache.tag_allocation[i] = 0;
+        }
+        if (t_cache.tag_alloc_count[i]) {
+            ATOMIC_ADD(&g_counter.tag_alloc_count[i],
+                       (uint64_t)t_cache.tag_alloc_count[i]);
+            t_cache.tag_alloc_count[i] = 0;
+        }
+    }
+    ATOMIC_ADD(&g_counter.total_allocated, t_cache.total_allocated);
+    ATOMIC_ADD(&g_cache_hits, t_cache.hits);
+    t_cache.total_allocated = 0;
+    t_cache.hits = 0;
+    t_cache.pending = 0;
+}
+
+static INL void counters_note(void) {
+    if (++t_cache.pending >= CACHE_FOLD_OPS) counters_fold();
+}
+
+static void lock_acquire(mutex_t *mutex) {
+    if (!mutex_trylock(mutex)) {
+        ATOMIC_ADD(&g_lock_contended, 1);
+        mutex_lock(mutex);
+    }
+    ATOMIC_ADD(&g_lock_acquired, 1);
+}
+
+static INL int32_t size_class(uint64_t size) {
+    if (size > CACHE_SMALL_MAX) return -1;
+    if (size <= (1u << CACHE_CLASS_MIN_LOG2)) return 0;
+    return 64 - __builtin_clzll(size - 1) - CACHE_CLASS_MIN_LOG2;
+}
+
+// The largest class a freed block can serve, judged by the heap's own record
+// of its size and not by what the caller passed to WFREE. System blocks and
+// anything too big to cache get -1.
+static INL int32_t block_class(const void *block) {
+    if (!tlsf_owns(g_heap, block)) return -1;
+    uint64_t bytes = tlsf_block_size(block);
+    if (bytes < (1u << CACHE_CLASS_MIN_LOG2) || bytes >= 2 * CACHE_SMALL_MAX) {
+        return -1;
+    }
+    return 63 - __builtin_clzll(bytes) - CACHE_CLASS_MIN_LOG2;
+}
+
+static void heap_free(void *block) {
+    if (tlsf_owns(g_heap, block)) {
+        lock_acquire(&g_heap_lock);
+        tlsf_free(g_heap, block);
+        mutex_unlock(&g_heap_lock);
+    } else {
+        free(block);
+    }
+}
+
+static void *block_acquire(uint64_t size, memtag_t tag) {
+    // budgeted tags reserve on the shared counter so the cap holds exactly
+    bool budgeted = g_budget[tag] != 0;
+    if (budgeted) {
+        uint64_t live = ATOMIC_ADD(&g_counter.tag_allocation[tag], size) + size;
+        if (live > g_budget[tag]) {
+            ATOMIC_SUB(&g_counter.tag_allocation[tag], size);
+            LOG_ERROR("%s over budget: %lu + %lu > %lu bytes", tag_str[tag],
+                      live - size, size, g_budget[tag]);
+            return NULL;
+        }
+    }
+
+    void *block = NULL;
+    int32_t cls = size_class(size);
+    if (cls >= 0 && t_cache.head[cls]) {
+        block = t_cache.head[cls];
+        t_cache.head[cls] = *(void **)block;
+        t_cache.count[cls]--;
+        t_cache.hits++;
+    } else {
+        // small blocks are sized to their class so any cached one fits
+        uint64_t bytes =
+            cls >= 0 ? 1ull << (cls + CACHE_CLASS_MIN_LOG2) : size;
+        if (g_heap) {
+            lock_acquire(&g_heap_lock);
+            block = tlsf_malloc(g_heap, bytes);
+            mutex_unlock(&g_heap_lock);
+            if (!block) ATOMIC_ADD(&g_heap_fallback, 1);
+        }
+        if (!block) block = malloc(bytes);
+        if (!block) {
+            if (budgeted) ATOMIC_SUB(&g_counter.tag_allocation[tag], size);
+            return NULL;
+        }
+    }
+
+    memset(block, 0, size);
+    if (!budgeted) t_cache.tag_allocation[tag] += (int64_t)size;
+    t_cache.tag_alloc_count[tag]++;
+    t_cache.total_allocated += size;
+    counters_note();
+
+    return block;
+}
+
+static void block_release(void *block, uint64_t size, memtag_t tag) {
+    if (g_budget[tag]) ATOMIC_SUB(&g_counter.tag_allocation[tag], size);
+    else t_cache.tag_allocation[tag] -= (int64_t)size;
+    t_cache.tag_alloc_count[tag]--;
+    counters_note();
+
+    int32_t cls = block_class(block);
+    if (cls >= 0 && t_cache.count[cls] < CACHE_DEPTH) {
+        *(void **)block = t_cache.head[cls];
+        t_cache.head[cls] = block;
+        t_cache.count[cls]++;
+        return;
+    }
+
+    heap_free(block);
+}
+
+void memory_thread_flush(void) {
+    counters_fold();
+    for (uint32_t i = 0; i < CACHE_CLASS_COUNT; ++i) {
+        void *block = t_cache.head[i];
+        while (block) {
+            void *next = *(void **)block;
+            heap_free(block);
+            block = next;
+        }
+        t_cache.head[i] = NULL;
+        t_cache.count[i] = 0;
+    }
+}
+
+static void heap_release(void) {
+    memory_thread_flush();
+    if (g_heap_memory) vmem_release(g_heap_memory, g_heap_size);
+    g_heap = NULL;
+    g_heap_memory = NULL;
+    g_heap_size = 0;
+    g_heap_fallback = 0;
+}
+
+bool memory_heap_init(uint64_t size) {
+    if (g_heap) return true;
+
+    g_heap_size = size;
+    g_heap_memory = vmem_reserve(size);
+    if (!g_heap_memory || !vmem_commit(g_heap_memory, size)) {
+        heap_release();
+        return false;
+    }
+
+    g_heap = tlsf_create(g_heap_memory, size);
+    if (!g_heap) {
+        heap_release();
+        return false;
+    }
+
+    LOG_INFO("engine heap initialized (%lu bytes)", size);
+    return true;
+}
+
+void memory_set_budget(memtag_t tag, uint64_t bytes) {
+    if (tag < MEM_MAX_TAG) {
+        counters_fold();
+        g_budget[tag] = bytes;
+    }
+}
+
+#ifndef _RELEASE
+#    define FRAME_SITE_MAX 16
+#    define SITE_CAPACITY 1024
+
+typedef struct {
+    const char *what;
+    const char *file;
+    uint32_t line;
+    uint64_t size;
+} frame_site_t;
+
+static struct {
+    bool enabled;
+    bool assert_on_alloc;
+    bool in_frame;
+    uint32_t warmup;
+    uint32_t frame;
+    uint32_t count;
+    frame_site_t sites[FRAME_SITE_MAX];
+} g_watch;
+
+void memory_frame_watch(uint32_t warmup, bool assert_on_alloc) {
+    g_watch.enabled = true;
+    g_watch.assert_on_alloc = assert_on_alloc;
+    g_watch.warmup = warmup;
+    g_watch.frame = 0;
+}
+
+void memory_frame_begin(void) {
+    if (!g_watch.enabled) return;
+    ATOMIC_STORE(&g_watch.count, 0);
+    g_watch.in_frame = true;
+}
+
+void memory_frame_record(const char *what, uint64_t size, const char *file,
+                         uint32_t line) {
+    if (!g_watch.in_frame) return;
+
+    uint32_t idx = ATOMIC_ADD(&g_watch.count, 1);
+    if (idx < FRAME_SITE_MAX) {
+        g_watch.sites[idx] = (frame_site_t){
+            .what = what, .file = file, .line = line, .size = size};
+    }
+}
+
+uint32_t memory_frame_end(void) {
+    if (!g_watch.in_frame) return 0;
+    g_watch.in_frame = false;
+
+    uint32_t count = ATOMIC_LOAD(&g_watch.count);
+    if (g_watch.frame < g_watch.warmup) {
+        g_watch.frame++;
+        return count;
+    }
+
+    if (count) {
+        LOG_WARN("frame %u made %u heap allocations after warm-up",
+                 g_watch.frame, count);
+        for (uint32_t i = 0; i < MIN(count, FRAME_SITE_MAX); ++i) {
+            const frame_site_t *site = &g_watch.sites[i];
+            LOG_WARN("  %s %lu bytes at %s:%u", site->what, site->size,
+                     site->file, site->line);
+        }
+        ASSERT(!g_watch.assert_on_alloc, "heap allocation in steady state");
+    }
+
+    g_watch.frame++;
+    return count;
+}
+
 typedef struct {
     memtag_t tag;
     uint64_t size;
@@ -28,10 +315,199 @@ typedef struct {
     void *ptr;
 } mem_state;
 
-static struct status g_counter = {0};
+// Open-addressing table keyed by block pointer. Capacity is always a power of
+// two, probing is linear and removal uses backward shift, so there are no
+// tombstones and both alloc and free stay O(1) regardless of live count.
+static mutex_t g_track_lock;
 static mem_state *g_mem;
 static uint64_t g_mem_count = 0;
 static uint64_t g_mem_capacity = 0;
+static uint64_t g_mem_max_probe = 0;
+
+static INL uint64_t ptr_slot(const void *ptr, uint64_t mask) {
+    // malloc blocks are 16-byte aligned, drop the dead bits then fibonacci mix
+    uint64_t key = (uint64_t)(uintptr_t)ptr >> 4;
+    return (key * 0x9E3779B97F4A7C15ull >> 17) & mask;
+}
+
+static void track_insert(const mem_state *state) {
+    uint64_t mask = g_mem_capacity - 1;
+    uint64_t i = ptr_slot(state->ptr, mask);
+    uint64_t probe = 0;
+
+    while (g_mem[i].ptr) {
+        i = (i + 1) & mask;
+        ++probe;
+    }
+
+    g_mem[i] = *state;
+    g_mem_count++;
+    if (probe > g_mem_max_probe) g_mem_max_probe = probe;
+}
+
+static bool track_grow(void) {
+    uint64_t old_capacity = g_mem_capacity;
+    mem_state *old = g_mem;
+
+    mem_state *table = calloc(old_capacity * 2, sizeof(mem_state));
+    if (!table) return false;
+
+    g_mem = table;
+    g_mem_capacity = old_capacity * 2;
+    g_mem_count = 0;
+    g_mem_max_probe = 0;
+    for (uint64_t i = 0; i < old_capacity; ++i) {
+        if (old[i].ptr) track_insert(&old[i]);
+    }
+
+    free(old);
+    return true;
+}
+
+static bool track_remove(const void *ptr, mem_state *out) {
+    uint64_t mask = g_mem_capacity - 1;
+    uint64_t i = ptr_slot(ptr, mask);
+
+    while (g_mem[i].ptr != ptr) {
+        if (!g_mem[i].ptr) return false;
+        i = (i + 1) & mask;
+    }
+    *out = g_mem[i];
+
+    // backward shift: pull later entries of the same run into the hole
+    uint64_t hole = i;
+    uint64_t j = (i + 1) & mask;
+    while (g_mem[j].ptr) {
+        uint64_t home = ptr_slot(g_mem[j].ptr, mask);
+        if (((j - home) & mask) >= ((j - hole) & mask)) {
+            g_mem[hole] = g_mem[j];
+            hole = j;
+        }
+        j = (j + 1) & mask;
+    }
+
+    g_mem[hole] = (mem_state){0};
+    g_mem_count--;
+    return true;
+}
+
+// Aggregated allocation profile keyed by call site. __FILE__ literals are not
+// guaranteed to be unique per file, so sites compare by string content.
+typedef struct {
+    const char *file;
+    uint32_t line;
+    memtag_t tag;
+    uint64_t alloc_count;
+    uint64_t free_count;
+    uint64_t bytes;
+    uint64_t live_bytes;
+    uint64_t peak_live;
+} alloc_site_t;
+
+static alloc_site_t g_sites[SITE_CAPACITY];
+static uint32_t g_site_count = 0;
+static double g_profile_start = 0;
+
+static alloc_site_t *site_get(const char *file, uint32_t line, memtag_t tag) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const char *c = file; *c; ++c) {
+        hash = (hash ^ (uint8_t)*c) * 0x100000001b3ull;
+    }
+    hash = (hash ^ line) * 0x100000001b3ull;
+
+    uint32_t mask = SITE_CAPACITY - 1;
+    uint32_t i = (uint32_t)(hash >> 32) & mask;
+    for (uint32_t n = 0; n < SITE_CAPACITY; ++n) {
+        alloc_site_t *site = &g_sites[i];
+        if (!site->file) {
+            if (g_site_count >= SITE_CAPACITY - 1) return NULL;
+            *site = (alloc_site_t){.file = file, .line = line, .tag = tag};
+            g_site_count++;
+            return site;
+        }
+        if (site->line == line &&
+            (site->file == file || strcmp(site->file, file) == 0)) {
+            return site;
+        }
+        i = (i + 1) & mask;
+    }
+    return NULL;
+}
+
+static int site_compare(const void *a, const void *b) {
+    const alloc_site_t *sa = a;
+    const alloc_site_t *sb = b;
+    if (sa->alloc_count != sb->alloc_count) {
+        return sa->alloc_count < sb->alloc_count ? 1 : -1;
+    }
+    return sa->bytes < sb->bytes ? 1 : (sa->bytes > sb->bytes ? -1 : 0);
+}
+
+bool mem_profile_dump(const char *path) {
+    size_t len = strlen(path);
+    bool json = len > 5 && strcmp(path + len - 5, ".json") == 0;
+
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        LOG_ERROR("cannot open memory profile output '%s'", path);
+        return false;
+    }
+
+    // snapshot under the lock, write without it
+    lock_acquire(&g_track_lock);
+    alloc_site_t *sites = malloc(sizeof(alloc_site_t) * SITE_CAPACITY);
+    uint32_t count = 0;
+    if (sites) {
+        for (uint32_t i = 0; i < SITE_CAPACITY; ++i) {
+            if (g_sites[i].file) sites[count++] = g_sites[i];
+        }
+    }
+    mutex_unlock(&g_track_lock);
+
+    if (!sites) {
+        fclose(file);
+        return false;
+    }
+
+    qsort(sites, count, sizeof(alloc_site_t), site_compare);
+
+    double elapsed = get_abs_time() - g_profile_start;
+    if (elapsed <= 0.0) elapsed = 1.0;
+
+    if (json) fprintf(file, "[\n");
+    else {
+        fprintf(file, "file,line,tag,allocs,frees,bytes,live_bytes,"
+                      "peak_live_bytes,allocs_per_sec\n");
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        const alloc_site_t *site = &sites[i];
+        double rate = (double)site->alloc_count / elapsed;
+        if (json) {
+            fprintf(file,
+                    "  {\"file\": \"%s\", \"line\": %u, \"tag\": \"%s\", "
+                    "\"allocs\": %lu, \"frees\": %lu, \"bytes\": %lu, "
+                    "\"live_bytes\": %lu, \"peak_live_bytes\": %lu, "
+                    "\"allocs_per_sec\": %.3f}%s\n",
+                    site->file, site->line, tag_str[site->tag],
+                    site->alloc_count, site->free_count, site->bytes,
+                    site->live_bytes, site->peak_live, rate,
+                    i + 1 < count ? "," : "");
+        } else {
+            fprintf(file, "%s,%u,%s,%lu,%lu,%lu,%lu,%lu,%.3f\n", site->file,
+                    site->line, tag_str[site->tag], site->alloc_count,
+                    site->free_count, site->bytes, site->live_bytes,
+                    site->peak_live, rate);
+        }
+    }
+    if (json) fprintf(file, "]\n");
+
+    fclose(file);
+    free(sites);
+
+    LOG_INFO("memory profile (%u call sites) written to %s", count, path);
+    return true;
+}
 
 static void memory_report_leaks(void) {
     if (g_mem_count == 0) {
@@ -41,80 +517,193 @@ static void memory_report_leaks(void) {
 
     printf("\n");
     LOG_WARN("====== MEMORY LEAKS (%lu) ======", g_mem_count);
-    for (uint64_t i = 0; i < g_mem_count; ++i) {
+    for (uint64_t i = 0; i < g_mem_capacity; ++i) {
         const mem_state *m = &g_mem[i];
+        if (!m->ptr) continue;
         LOG_WARN("at %s:%u → %lu bytes [%s]", m->file, m->line, m->size,
                  tag_str[m->tag]);
     }
 }
 
 bool memory_system_init(uint64_t total_size) {
-    g_mem_capacity = total_size / sizeof(mem_state);
-    // g_mem = platform_allocate(sizeof(mem_state) * g_mem_capacity, false);
-    g_mem = malloc(sizeof(mem_state) * g_mem_capacity);
+    // round the budget down to a power of two slot count
+    uint64_t slots = total_size / sizeof(mem_state);
+    g_mem_capacity = MAX_ALLOC_TRACK;
+    while (g_mem_capacity * 2 <= slots) {
+        g_mem_capacity *= 2;
+    }
+
+    g_mem = calloc(g_mem_capacity, sizeof(mem_state));
     if (!g_mem) return false;
 
+    if (!mutex_create(&g_heap_lock) || !mutex_create(&g_track_lock)) {
+        free(g_mem);
+        g_mem = 0;
+        return false;
+    }
+
     g_mem_count = 0;
+    g_mem_max_probe = 0;
     g_counter = (struct status){0};
 
+    memset(g_sites, 0, sizeof(g_sites));
+    g_site_count = 0;
+    g_profile_start = get_abs_time();
+
     return true;
 }
 
 void memory_system_kill(void) {
     if (g_mem) {
+        counters_fold();
         memory_report_leaks();
         free(g_mem);
         g_mem = 0;
         g_mem_count = 0;
+        g_mem_capacity = 0;
+        heap_release();
+        mutex_kill(&g_track_lock);
+        mutex_kill(&g_heap_lock);
         LOG_INFO("Memory system kill");
     }
 }
 
 void *alloc_dbg(uint64_t size, memtag_t tag, const char *file, uint32_t line) {
-    void *block = malloc(size);
+    void *block = block_acquire(size, tag);
     if (!block) return 0;
 
-    memset(block, 0, size);
-    if (g_mem_count < g_mem_capacity) {
-        g_mem[g_mem_count++] = (mem_state){
-            .ptr = block,
-            .size = size,
-            .tag = tag,
-            .file = file,
-            .line = line,
-        };
-    }
+    memory_frame_record("WALLOC", size, file, line);
 
-    g_counter.total_allocated += size;
-    g_counter.tag_alloc_count[tag]++;
-    g_counter.tag_allocation[tag] += size;
+    if (g_mem) {
+        lock_acquire(&g_track_lock);
+        if ((g_mem_count + 1) * TRACK_LOAD_DEN >
+            g_mem_capacity * TRACK_LOAD_NUM) {
+            if (!track_grow()) {
+                LOG_WARN("allocation tracking table full, %s:%u untracked",
+                         file, line);
+            }
+        }
+
+        if ((g_mem_count + 1) * TRACK_LOAD_DEN <=
+            g_mem_capacity * TRACK_LOAD_NUM) {
+            mem_state state = {
+                .ptr = block,
+                .size = size,
+                .tag = tag,
+                .file = file,
+                .line = line,
+            };
+            track_insert(&state);
+        }
+
+        alloc_site_t *site = site_get(file, line, tag);
+        if (site) {
+            site->alloc_count++;
+            site->bytes += size;
+            site->live_bytes += size;
+            if (site->live_bytes > site->peak_live) {
+                site->peak_live = site->live_bytes;
+            }
+        }
+        mutex_unlock(&g_track_lock);
+    }
 
     return block;
 }
 
-void alloc_free(void *block, uint64_t size, memtag_t tag) {
+void alloc_free(void *block, uint64_t size, memtag_t tag, const char *file,
+                uint32_t line) {
     if (!block) return;
 
-    bool found = false;
-    for (uint64_t i = 0; i < g_mem_count; ++i) {
-        if (g_mem[i].ptr == block) {
-            g_mem[i] = g_mem[--g_mem_count];
-            found = true;
+    memory_frame_record("WFREE", size, file, line);
 
-            break;
+    if (g_mem) {
+        mem_state state;
+        lock_acquire(&g_track_lock);
+        bool found = track_remove(block, &state);
+        if (found) {
+            alloc_site_t *site = site_get(state.file, state.line, state.tag);
+            if (site) {
+                site->free_count++;
+                site->live_bytes -= state.size;
+            }
         }
+        mutex_unlock(&g_track_lock);
+
+        // a double free would put the block in the thread cache twice
+        if (!found) {
+            LOG_WARN("attempted to free unknown ptr %p at %s:%u", block, file,
+                     line);
+            return;
+        }
+        ASSERT(state.size == size, "WFREE size differs from WALLOC");
     }
 
-    if (!found) {
-        LOG_WARN("attempted to free unknown ptr %p", block);
+    block_release(block, size, tag);
+}
+
+#else
+// Release build: no per-block records, only the per-tag counters.
+static void memory_report_leaks(void) {
+    uint64_t live = 0;
+    for (uint32_t i = 0; i < MEM_MAX_TAG; ++i) {
+        if (!g_counter.tag_alloc_count[i]) continue;
+        LOG_WARN("%s still holds %lu blocks (%lu bytes)", tag_str[i],
+                 g_counter.tag_alloc_count[i], g_counter.tag_allocation[i]);
+        live += g_counter.tag_alloc_count[i];
     }
 
-    free(block);
+    if (live == 0) LOG_INFO("No memory leaks detected.");
+}
+
+bool memory_system_init(uint64_t total_size) {
+    UNUSED(total_size);
+    g_counter = (struct status){0};
+    return mutex_create(&g_heap_lock);
+}
+
+void memory_system_kill(void) {
+    counters_fold();
+    memory_report_leaks();
+    heap_release();
+    mutex_kill(&g_heap_lock);
+    LOG_INFO("Memory system kill");
+}
+
+void memory_frame_watch(uint32_t warmup, bool assert_on_alloc) {
+    UNUSED(warmup);
+    UNUSED(assert_on_alloc);
+}
+
+void memory_frame_begin(void) {}
+
+uint32_t memory_frame_end(void) {
+    return 0;
+}
+
+void memory_frame_record(const char *what, uint64_t size, const char *file,
+                         uint32_t line) {
+    UNUSED(what);
+    UNUSED(size);
+    UNUSED(file);
+    UNUSED(line);
+}
 
-    g_counter.tag_alloc_count[tag]--;
-    g_counter.tag_allocation[tag] -= size;
+bool mem_profile_dump(const char *path) {
+    UNUSED(path);
+    LOG_WARN("call-site memory profile needs a debug build");
+    return false;
 }
 
+void *alloc_raw(uint64_t size, memtag_t tag) {
+    return block_acquire(size, tag);
+}
+
+void free_raw(void *block, uint64_t size, memtag_t tag) {
+    if (block) block_release(block, size, tag);
+}
+#endif
+
 char *mem_debug_stat(void) {
     const uint64_t Gib = 1024 * 1024 * 1024;
     const uint64_t Mib = 1024 * 1024;
@@ -122,13 +711,47 @@ char *mem_debug_stat(void) {
 
     static char buffer[BUFFER_SIZE];
     uint64_t offset = 0;
+    // other threads' counts lag by at most CACHE_FOLD_OPS calls each
+    counters_fold();
     offset += (uint64_t)snprintf(buffer + offset, sizeof(buffer) - offset,
                                  "Game Memory Used:\n");
+#ifndef _RELEASE
+    offset += (uint64_t)snprintf(
+        buffer + offset, sizeof(buffer) - offset,
+        "--> tracked: %lu/%lu slots, max probe %lu\n", g_mem_count,
+        g_mem_capacity, g_mem_max_probe);
+#endif
+    if (g_heap) {
+        tlsf_stat_t heap;
+        tlsf_stats(g_heap, &heap);
+        // share of free space not usable by a single allocation
+        float frag = heap.free_size ? (1.0f - (float)heap.largest_free /
+                                                  (float)heap.free_size) *
+                                          100.0f
+                                    : 0.0f;
+        offset += (uint64_t)snprintf(
+            buffer + offset, sizeof(buffer) - offset,
+            "--> heap: %.2fMib/%.2fMib used, %u free blocks, largest "
+            "%.2fMib, fragmentation %.1f%%, %lu fallbacks\n",
+            (float)heap.used_size / (float)Mib,
+            (float)heap.total_size / (float)Mib, heap.free_blocks,
+            (float)heap.largest_free / (float)Mib, frag,
+            ATOMIC_LOAD(&g_heap_fallback));
+    }
+
+    uint64_t acquired = ATOMIC_LOAD(&g_lock_acquired);
+    uint64_t contended = ATOMIC_LOAD(&g_lock_contended);
+    offset += (uint64_t)snprintf(
+        buffer + offset, sizeof(buffer) - offset,
+        "--> locks: %lu taken, %lu contended (%.2f%%), %lu cache hits\n",
+        acquired, contended,
+        acquired ? (float)contended / (float)acquired * 100.0f : 0.0f,
+        ATOMIC_LOAD(&g_cache_hits));
 
     for (uint32_t i = 0; i < MEM_MAX_TAG; ++i) {
         char *unit = "B";
-        uint32_t count = (uint32_t)g_counter.tag_alloc_count[i];
-        float amount = (float)g_counter.tag_allocation[i];
+        uint32_t count = (uint32_t)ATOMIC_LOAD(&g_counter.tag_alloc_count[i]);
+        float amount = (float)ATOMIC_LOAD(&g_counter.tag_allocation[i]);
 
         if (count == 0) {
             continue;
@@ -144,7 +767,6 @@ char *mem_debug_stat(void) {
             amount /= (float)Kib;
             unit = "Kib";
         }
-        count = (uint32_t)g_counter.tag_alloc_count[i];
 
         int32_t length =
             snprintf(buffer + offset, sizeof(buffer) - offset,
@@ -18,16 +18,51 @@ typedef enum {
     MEM_MAX_TAG
 } memtag_t;
 
-#define WALLOC(size, tag) alloc_dbg(size, tag, __FILE__, __LINE__)
-#define WFREE(block, size, tag) alloc_free(block, size, tag)
+#ifndef _RELEASE
+#    define WALLOC(size, tag) alloc_dbg(size, tag, __FILE__, __LINE__)
+#    define WFREE(block, size, tag)                                            \
+        alloc_free(block, size, tag, __FILE__, __LINE__)
+#else
+#    define WALLOC(size, tag) alloc_raw(size, tag)
+#    define WFREE(block, size, tag) free_raw(block, size, tag)
+#endif
 
 bool memory_system_init(uint64_t total_size);
 void memory_system_kill(void);
 
+// Route WALLOC through a TLSF heap carved from one reservation of `size`
+// bytes. Requests that do not fit fall back to the system allocator.
+bool memory_heap_init(uint64_t size);
+// Hard cap on live bytes per tag, WALLOC returns NULL past it. 0 = no cap.
+// Set it before other threads allocate with the tag.
+void memory_set_budget(memtag_t tag, uint64_t bytes);
+// Hand the calling thread's cached small blocks back to the heap, worker
+// threads call this before they exit.
+void memory_thread_flush(void);
+
+#ifndef _RELEASE
 void *alloc_dbg(uint64_t size, memtag_t tag, const char *file, uint32_t line);
-void alloc_free(void *block, uint64_t size, memtag_t tag);
+void alloc_free(void *block, uint64_t size, memtag_t tag, const char *file,
+                uint32_t line);
+#else
+void *alloc_raw(uint64_t size, memtag_t tag);
+void free_raw(void *block, uint64_t size, memtag_t tag);
+#endif
+
+// Per-frame allocation watch (debug builds). Between memory_frame_begin and
+// memory_frame_end every WALLOC/WFREE, and anything reported through
+// memory_frame_record, is counted with its call site. After `warmup` frames a
+// non-zero count is logged, or asserted when `assert_on_alloc` is set.
+void memory_frame_watch(uint32_t warmup, bool assert_on_alloc);
+void memory_frame_begin(void);
+uint32_t memory_frame_end(void);
+void memory_frame_record(const char *what, uint64_t size, const char *file,
+                         uint32_t line);
 
 char *mem_debug_stat(void);
+// Write the per-call-site profile (allocs, frees, bytes, live and peak live
+// bytes, allocs/sec). `.json` paths get JSON, anything else CSV.
+bool mem_profile_dump(const char *path);
 // void memory_report_leaks(void);
 
 #endif // MEMORY_H
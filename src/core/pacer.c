@@ -0,0 +1,82 @@
+#include "pacer.h"
+#include "platform/window.h"
+#include "platform/thread.h"
+
+#include <math.h>
+#include <string.h>
+
+#define SPIN_MIN 0.0001 // never trust the sleep closer than this
+#define SPIN_MAX 0.002
+#define SPIN_PAD 0.00005
+#define SLOP_DECAY 0.99 // per frame, a bad wake-up is forgotten in seconds
+
+static void accum_add(pacer_accum_t *acc, double dt) {
+    acc->frames++;
+    double d = dt - acc->mean;
+    acc->mean += d / (double)acc->frames;
+    acc->m2 += d * (dt - acc->mean);
+    acc->worst = MAX(acc->worst, dt);
+}
+
+static pacer_stats_t accum_stats(const pacer_accum_t *acc) {
+    pacer_stats_t out = {.frames = acc->frames};
+    if (acc->frames == 0) return out;
+    out.mean = acc->mean * 1000.0;
+    out.worst = acc->worst * 1000.0;
+    if (acc->frames > 1) {
+        out.stddev = sqrt(acc->m2 / (double)(acc->frames - 1)) * 1000.0;
+    }
+    return out;
+}
+
+void pacer_init(pacer_t *p, double fps) {
+    memset(p, 0, sizeof(pacer_t));
+    p->period = fps > 0.0 ? 1.0 / fps : 0.0;
+    p->spin = 0.0005;
+    pacer_resync(p);
+}
+
+void pacer_wait(pacer_t *p) {
+    double now = get_abs_time();
+    if (p->period > 0.0) {
+        p->next += p->period;
+        if (now > p->next) {
+            // late, start over from here instead of rushing to catch up
+            p->missed++;
+            p->next = now;
+        } else {
+            double coarse = p->next - p->spin;
+            if (coarse > now) {
+                get_sleep(coarse);
+                double over = get_abs_time() - coarse;
+                // woke up past the deadline, the spin can't save this one
+                if (over > p->spin) p->missed++;
+                p->slop = MAX(over, p->slop * SLOP_DECAY);
+                double spin = p->slop + SPIN_PAD;
+                p->spin = CLAMP(spin, SPIN_MIN, SPIN_MAX);
+            }
+            while ((now = get_abs_time()) < p->next) {
+                CPU_RELAX();
+            }
+        }
+    }
+
+    if (p->last > 0.0) {
+        accum_add(&p->recent, now - p->last);
+        accum_add(&p->total, now - p->last);
+    }
+    p->last = now;
+}
+
+void pacer_resync(pacer_t *p) {
+    p->next = get_abs_time();
+    p->last = 0.0;
+}
+
+pacer_stats_t pacer_take_recent(pacer_t *p) {
+    pacer_stats_t out = accum_stats(&p->recent);
+    memset(&p->recent, 0, sizeof(pacer_accum_t));
+    return out;
+}
+
+pacer_stats_t pacer_total(const pacer_t *p) { return accum_stats(&p->total); }
@@ -0,0 +1,45 @@
+#ifndef PACER_H
+#define PACER_H
+
+#include "define.h" // IWYU pragma: keep
+
+// running mean and variance of frame-to-frame intervals (Welford)
+typedef struct {
+    uint64_t frames;
+    double mean;
+    double m2;
+    double worst;
+} pacer_accum_t;
+
+typedef struct {
+    uint64_t frames;
+    double mean, stddev, worst; // milliseconds
+} pacer_stats_t;
+
+// Frame limiter. The coarse sleep wakes `spin` seconds before the deadline
+// and the rest is busy-waited, so scheduler wake-up slop can't push a frame
+// past it. `spin` follows the worst oversleep seen recently.
+typedef struct {
+    double period; // seconds per frame, 0 runs unthrottled
+    double next;   // deadline of the frame being paced
+    double last;   // when the previous frame was released, 0 = none
+    double spin;
+    double slop;     // decaying worst overshoot of the coarse sleep
+    uint64_t missed; // frames that were already late at the deadline
+
+    pacer_accum_t recent; // since the last pacer_take_recent
+    pacer_accum_t total;
+} pacer_t;
+
+void pacer_init(pacer_t *p, double fps);
+// Waits out the rest of the current frame and releases the next one.
+void pacer_wait(pacer_t *p);
+// After a stall (idle wait, suspend): restart the schedule from now and
+// leave the gap out of the statistics.
+void pacer_resync(pacer_t *p);
+
+// intervals since the previous call, then starts a new window
+pacer_stats_t pacer_take_recent(pacer_t *p);
+pacer_stats_t pacer_total(const pacer_t *p);
+
+#endif // PACER_H
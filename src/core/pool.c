@@ -0,0 +1,92 @@
+#include "pool.h"
+
+#include <string.h>
+
+static INL uint64_t slab_bytes(const pool_alloc_t *pool) {
+    // header + worst-case alignment padding + slots
+    return sizeof(pool_slab_t) + POOL_CACHE_LINE +
+           pool->slot_size * pool->slots_per_slab;
+}
+
+bool pool_create(pool_alloc_t *pool, uint64_t item_size,
+                 uint32_t slots_per_slab, memtag_t tag) {
+    if (!pool || item_size == 0 || slots_per_slab == 0) return false;
+
+    memset(pool, 0, sizeof(pool_alloc_t));
+    // every slot starts on its own cache line and can hold a free-list link
+    uint64_t size = MAX(item_size, sizeof(void *));
+    pool->slot_size =
+        (size + (POOL_CACHE_LINE - 1)) & ~((uint64_t)POOL_CACHE_LINE - 1);
+    pool->slots_per_slab = slots_per_slab;
+    pool->tag = tag;
+
+    return true;
+}
+
+void pool_kill(pool_alloc_t *pool) {
+    if (!pool) return;
+
+    if (pool->live_count) {
+        LOG_WARN("pool killed with %u live slots", pool->live_count);
+    }
+
+    pool_slab_t *slab = pool->slabs;
+    while (slab) {
+        pool_slab_t *next = slab->next;
+        WFREE(slab, slab_bytes(pool), pool->tag);
+        slab = next;
+    }
+    memset(pool, 0, sizeof(pool_alloc_t));
+}
+
+static bool pool_grow(pool_alloc_t *pool) {
+    pool_slab_t *slab = WALLOC(slab_bytes(pool), pool->tag);
+    if (!slab) return false;
+
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->slab_count++;
+
+    uintptr_t first = ((uintptr_t)(slab + 1) + (POOL_CACHE_LINE - 1)) &
+                      ~((uintptr_t)POOL_CACHE_LINE - 1);
+
+    // thread slots so the lowest address is handed out first
+    for (uint32_t i = pool->slots_per_slab; i > 0; --i) {
+        void **slot = (void **)(first + (i - 1) * pool->slot_size);
+        *slot = pool->free_list;
+        pool->free_list = slot;
+    }
+    return true;
+}
+
+void *pool_alloc(pool_alloc_t *pool) {
+    if (!pool) return NULL;
+
+    if (!pool->free_list && !pool_grow(pool)) {
+        LOG_ERROR("pool out of memory (slot %lu bytes)", pool->slot_size);
+        return NULL;
+    }
+
+    void **slot = pool->free_list;
+    pool->free_list = *slot;
+    memset(slot, 0, pool->slot_size);
+
+    pool->alloc_count++;
+    pool->live_count++;
+    if (pool->live_count > pool->peak_count) {
+        pool->peak_count = pool->live_count;
+    }
+
+    return slot;
+}
+
+void pool_free(pool_alloc_t *pool, void *ptr) {
+    if (!pool || !ptr) return;
+
+    void **slot = ptr;
+    *slot = pool->free_list;
+    pool->free_list = slot;
+
+    pool->free_count++;
+    pool->live_count--;
+}
@@ -0,0 +1,41 @@
+#ifndef POOL_ALLOC_H
+#define POOL_ALLOC_H
+
+#include "define.h"
+#include "memory.h"
+
+#define POOL_CACHE_LINE 64
+
+typedef struct pool_slab {
+    struct pool_slab *next;
+} pool_slab_t;
+
+// Fixed-size object pool: slots are carved from slabs and recycled through an
+// intrusive free list, slabs are only returned to the heap on pool_kill.
+typedef struct {
+    uint64_t slot_size;
+    uint32_t slots_per_slab;
+    memtag_t tag;
+
+    pool_slab_t *slabs;
+    void *free_list;
+
+    uint32_t slab_count;
+    uint32_t live_count;
+    uint32_t peak_count;
+    uint64_t alloc_count;
+    uint64_t free_count;
+} pool_alloc_t;
+
+bool pool_create(pool_alloc_t *pool, uint64_t item_size,
+                 uint32_t slots_per_slab, memtag_t tag);
+void pool_kill(pool_alloc_t *pool);
+
+void *pool_alloc(pool_alloc_t *pool);
+void pool_free(pool_alloc_t *pool, void *ptr);
+
+#define POOL_CREATE(pool, type, slots_per_slab, tag)                           \
+    pool_create(pool, sizeof(type), slots_per_slab, tag)
+#define POOL_ALLOC(pool, type) ((type *)pool_alloc(pool))
+
+#endif // POOL_ALLOC_H
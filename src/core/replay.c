@@ -0,0 +1,215 @@
+#include "replay.h"
+#include "memory.h"
+#include "latency.h"
+#include "binary_loader.h"
+#include "platform/filesystem.h"
+#include "platform/window.h"
+
+#include <string.h>
+
+#define REPLAY_MAGIC 0x4C505257u // "WRPL"
+#define REPLAY_VERSION 1
+#define REPLAY_FIXED_DELTA (1.0f / 60.0f)
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    float delta;
+    uint32_t _pad;
+} replay_header_t;
+
+typedef struct {
+    uint32_t frame;
+    float time; // seconds since recording started
+    event_t ev;
+} replay_record_t;
+
+struct replay_t {
+    replay_mode_t mode;
+    uint32_t frame;
+    double start_time;
+
+    // record
+    file_t file;
+    uint32_t written;
+
+    // play
+    uint8_t *data;
+    uint64_t data_size;
+    const replay_record_t *records;
+    uint32_t record_count;
+    uint32_t cursor;
+    float delta;
+
+    double total_time;
+    double worst_time;
+};
+
+static void record_event(const event_t *ev, void *user) {
+    replay_t *replay = user;
+
+    replay_record_t rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.frame = replay->frame;
+    rec.time = (float)(get_abs_time() - replay->start_time);
+    rec.ev = *ev;
+
+    if (filesys_write(&replay->file, &rec, sizeof(rec))) {
+        replay->written++;
+    }
+}
+
+static bool open_record(replay_t *replay, event_system_t *event,
+                        const char *path) {
+    if (!filesys_open(path, WRITE_BINARY, &replay->file)) return false;
+
+    replay_header_t header = {.magic = REPLAY_MAGIC,
+                              .version = REPLAY_VERSION,
+                              .record_size = sizeof(replay_record_t),
+                              .delta = REPLAY_FIXED_DELTA};
+    if (!filesys_write(&replay->file, &header, sizeof(header))) {
+        filesys_close(&replay->file);
+        return false;
+    }
+
+    event_set_observer(event, record_event, replay);
+    LOG_INFO("recording input to '%s'", path);
+    return true;
+}
+
+static bool open_play(replay_t *replay, const char *path) {
+    replay->data = read_file_binary(path, &replay->data_size);
+    if (!replay->data) return false;
+
+    const replay_header_t *header = (const replay_header_t *)replay->data;
+    if (replay->data_size < sizeof(replay_header_t) ||
+        header->magic != REPLAY_MAGIC || header->version != REPLAY_VERSION ||
+        header->record_size != sizeof(replay_record_t)) {
+        LOG_ERROR("'%s' is not a compatible replay file", path);
+        WFREE(replay->data, replay->data_size, MEM_RESOURCE);
+        replay->data = NULL;
+        return false;
+    }
+
+    replay->delta = header->delta;
+    replay->records =
+        (const replay_record_t *)(replay->data + sizeof(replay_header_t));
+    replay->record_count =
+        (uint32_t)((replay->data_size - sizeof(replay_header_t)) /
+                   sizeof(replay_record_t));
+
+    LOG_INFO("replaying '%s': %u events, fixed delta %.4f", path,
+             replay->record_count, (double)replay->delta);
+    return true;
+}
+
+replay_t *replay_init(arena_alloc_t *arena, event_system_t *event,
+                      replay_mode_t mode, const char *path) {
+    if (mode == REPLAY_OFF) return NULL;
+
+    replay_t *replay = arena_alloc(arena, sizeof(replay_t));
+    if (!replay) return NULL;
+
+    memset(replay, 0, sizeof(replay_t));
+    replay->mode = mode;
+    replay->start_time = get_abs_time();
+
+    bool opened = mode == REPLAY_RECORD ? open_record(replay, event, path)
+                                        : open_play(replay, path);
+    if (!opened) {
+        LOG_ERROR("replay '%s' unavailable, running live", path);
+        return NULL;
+    }
+    return replay;
+}
+
+void replay_kill(replay_t *replay) {
+    if (!replay) return;
+
+    if (replay->mode == REPLAY_RECORD) {
+        LOG_INFO("recorded %u events over %u frames", replay->written,
+                 replay->frame);
+        filesys_close(&replay->file);
+    } else {
+        // the numbers a perf regression run compares
+        double avg = replay->frame ? replay->total_time / replay->frame : 0;
+        LOG_INFO("replay: %u frames, avg %.3fms, worst %.3fms",
+                 replay->frame, avg * 1000.0, replay->worst_time * 1000.0);
+        WFREE(replay->data, replay->data_size, MEM_RESOURCE);
+    }
+    memset(replay, 0, sizeof(replay_t));
+}
+
+bool replay_is_playing(const replay_t *replay) {
+    return replay && replay->mode == REPLAY_PLAY;
+}
+
+float replay_delta(const replay_t *replay) {
+    return replay ? replay->delta : 0.0f;
+}
+
+static void feed(input_system_t *input, event_system_t *event,
+                 const event_t *ev) {
+    switch (ev->type) {
+        case EVENT_KEY_PRESS: {
+            input_keys_t key = (input_keys_t)ev->data.keys.keycode;
+            if (ev->data.keys.is_repeat) {
+                input_process_key_repeat(input, event, key);
+            } else {
+                input_process_key(input, event, key, true);
+            }
+        } break;
+
+        case EVENT_KEY_RELEASE: {
+            input_process_key(input, event,
+                              (input_keys_t)ev->data.keys.keycode, false);
+        } break;
+
+        case EVENT_MOUSE_PRESS:
+        case EVENT_MOUSE_RELEASE: {
+            input_process_button(input, event,
+                                 (input_button_t)ev->data.mouse_button.button,
+                                 ev->type == EVENT_MOUSE_PRESS);
+        } break;
+
+        case EVENT_MOUSE_MOVE: {
+            input_process_mouse_move(input, event,
+                                     (int16_t)ev->data.mouse_move.x,
+                                     (int16_t)ev->data.mouse_move.y);
+        } break;
+
+        case EVENT_MOUSE_WHEEL: {
+            input_process_mouse_wheel(
+                input, event, (int8_t)ev->data.mouse_button.wheel_delta);
+        } break;
+
+        // window events carry no input state
+        default: event_push(event, ev->type, ev, NULL); break;
+    }
+}
+
+bool replay_pump(replay_t *replay, input_system_t *input,
+                 event_system_t *event) {
+    // one more frame runs after the last event so its effect is simulated
+    if (replay->cursor >= replay->record_count) return false;
+
+    while (replay->cursor < replay->record_count &&
+           replay->records[replay->cursor].frame <= replay->frame) {
+        const event_t *ev = &replay->records[replay->cursor].ev;
+        if (ev->type >= EVENT_KEY_PRESS && ev->type <= EVENT_MOUSE_RAW) {
+            latency_input();
+        }
+        feed(input, event, ev);
+        replay->cursor++;
+    }
+    return true;
+}
+
+void replay_end_frame(replay_t *replay, double frame_time) {
+    if (!replay) return;
+
+    replay->frame++;
+    replay->total_time += frame_time;
+    replay->worst_time = MAX(replay->worst_time, frame_time);
+}
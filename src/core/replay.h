@@ -0,0 +1,35 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "define.h"
+#include "arena.h"
+#include "event.h"
+#include "input.h"
+
+// Input record/replay for repeatable performance runs. Recording writes
+// every event pushed by the platform layer with its frame number to a
+// binary file. Playback feeds the file back in place of the window pump
+// at a fixed delta, so the simulation is identical on every run.
+typedef enum {
+    REPLAY_OFF = 0,
+    REPLAY_RECORD,
+    REPLAY_PLAY
+} replay_mode_t;
+
+typedef struct replay_t replay_t;
+
+replay_t *replay_init(arena_alloc_t *arena, event_system_t *event,
+                      replay_mode_t mode, const char *path);
+void replay_kill(replay_t *replay);
+
+bool replay_is_playing(const replay_t *replay);
+// delta to simulate with while playing back
+float replay_delta(const replay_t *replay);
+
+// Feed this frame's recorded events through the input and event systems.
+// Returns false once the recording is exhausted.
+bool replay_pump(replay_t *replay, input_system_t *input,
+                 event_system_t *event);
+void replay_end_frame(replay_t *replay, double frame_time);
+
+#endif // REPLAY_H
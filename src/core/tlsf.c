@@ -0,0 +1,311 @@
+#include "tlsf.h"
+
+#include <string.h>
+
+#define ALIGN_LOG2 4
+#define ALIGN_SIZE (1ull << ALIGN_LOG2)
+
+#define SL_INDEX_LOG2 5
+#define SL_INDEX_COUNT (1u << SL_INDEX_LOG2)
+#define FL_INDEX_MAX 38
+#define FL_INDEX_SHIFT (SL_INDEX_LOG2 + ALIGN_LOG2)
+#define FL_INDEX_COUNT (FL_INDEX_MAX - FL_INDEX_SHIFT + 1)
+#define SMALL_BLOCK_SIZE (1ull << FL_INDEX_SHIFT)
+
+#define BLOCK_FREE 0x1ull
+#define BLOCK_PREV_FREE 0x2ull
+#define BLOCK_FLAGS (BLOCK_FREE | BLOCK_PREV_FREE)
+
+// Every block starts with a 16 byte header, the free-list links live in the
+// payload and only exist while the block is free.
+typedef struct tlsf_block {
+    struct tlsf_block *prev_phys;
+    uint64_t size;
+    struct tlsf_block *next_free;
+    struct tlsf_block *prev_free;
+} tlsf_block_t;
+
+#define BLOCK_HEADER (2 * sizeof(uint64_t))
+#define BLOCK_MIN (sizeof(tlsf_block_t) - BLOCK_HEADER)
+#define BLOCK_MAX (1ull << FL_INDEX_MAX)
+
+struct tlsf_t {
+    tlsf_block_t null_block;
+    uint32_t fl_bitmap;
+    uint32_t sl_bitmap[FL_INDEX_COUNT];
+    tlsf_block_t *blocks[FL_INDEX_COUNT][SL_INDEX_COUNT];
+
+    uint8_t *pool_start;
+    uint8_t *pool_end;
+};
+
+static INL int32_t bit_fls(uint64_t x) {
+    return x ? 63 - __builtin_clzll(x) : -1;
+}
+
+static INL int32_t bit_ffs(uint32_t x) {
+    return x ? __builtin_ctz(x) : -1;
+}
+
+static INL uint64_t block_size(const tlsf_block_t *b) {
+    return b->size & ~BLOCK_FLAGS;
+}
+
+static INL void block_set_size(tlsf_block_t *b, uint64_t size) {
+    b->size = size | (b->size & BLOCK_FLAGS);
+}
+
+static INL bool block_is_free(const tlsf_block_t *b) {
+    return (b->size & BLOCK_FREE) != 0;
+}
+
+static INL bool block_is_last(const tlsf_block_t *b) {
+    return block_size(b) == 0;
+}
+
+static INL void *block_to_ptr(const tlsf_block_t *b) {
+    return (uint8_t *)b + BLOCK_HEADER;
+}
+
+static INL tlsf_block_t *block_from_ptr(const void *ptr) {
+    return (tlsf_block_t *)((uint8_t *)ptr - BLOCK_HEADER);
+}
+
+static INL tlsf_block_t *block_next(const tlsf_block_t *b) {
+    return (tlsf_block_t *)((uint8_t *)block_to_ptr(b) + block_size(b));
+}
+
+static INL tlsf_block_t *block_link_next(tlsf_block_t *b) {
+    tlsf_block_t *next = block_next(b);
+    next->prev_phys = b;
+    return next;
+}
+
+static void block_mark_free(tlsf_block_t *b) {
+    tlsf_block_t *next = block_link_next(b);
+    next->size |= BLOCK_PREV_FREE;
+    b->size |= BLOCK_FREE;
+}
+
+static void block_mark_used(tlsf_block_t *b) {
+    tlsf_block_t *next = block_next(b);
+    next->size &= ~BLOCK_PREV_FREE;
+    b->size &= ~BLOCK_FREE;
+}
+
+static void mapping_insert(uint64_t size, int32_t *fli, int32_t *sli) {
+    if (size < SMALL_BLOCK_SIZE) {
+        *fli = 0;
+        *sli = (int32_t)(size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT));
+    } else {
+        int32_t fl = bit_fls(size);
+        *sli = (int32_t)(size >> (fl - SL_INDEX_LOG2)) ^ (1 << SL_INDEX_LOG2);
+        *fli = fl - (FL_INDEX_SHIFT - 1);
+    }
+}
+
+// round up to the next list so any block found there is large enough
+static void mapping_search(uint64_t size, int32_t *fli, int32_t *sli) {
+    if (size >= SMALL_BLOCK_SIZE) {
+        size += (1ull << (bit_fls(size) - SL_INDEX_LOG2)) - 1;
+    }
+    mapping_insert(size, fli, sli);
+}
+
+static tlsf_block_t *search_suitable(tlsf_t *t, int32_t *fli, int32_t *sli) {
+    int32_t fl = *fli;
+    uint32_t sl_map = t->sl_bitmap[fl] & (~0u << *sli);
+
+    if (!sl_map) {
+        uint32_t fl_map = fl + 1 < 32 ? t->fl_bitmap & (~0u << (fl + 1)) : 0;
+        if (!fl_map) return NULL;
+
+        fl = bit_ffs(fl_map);
+        *fli = fl;
+        sl_map = t->sl_bitmap[fl];
+    }
+
+    *sli = bit_ffs(sl_map);
+    return t->blocks[fl][*sli];
+}
+
+static void remove_free(tlsf_t *t, tlsf_block_t *b, int32_t fl, int32_t sl) {
+    tlsf_block_t *prev = b->prev_free;
+    tlsf_block_t *next = b->next_free;
+    next->prev_free = prev;
+    prev->next_free = next;
+
+    if (t->blocks[fl][sl] == b) {
+        t->blocks[fl][sl] = next;
+        if (next == &t->null_block) {
+            t->sl_bitmap[fl] &= ~(1u << sl);
+            if (!t->sl_bitmap[fl]) t->fl_bitmap &= ~(1u << fl);
+        }
+    }
+}
+
+static void insert_free(tlsf_t *t, tlsf_block_t *b, int32_t fl, int32_t sl) {
+    tlsf_block_t *head = t->blocks[fl][sl];
+    b->next_free = head;
+    b->prev_free = &t->null_block;
+    head->prev_free = b;
+
+    t->blocks[fl][sl] = b;
+    t->fl_bitmap |= 1u << fl;
+    t->sl_bitmap[fl] |= 1u << sl;
+}
+
+static void block_remove(tlsf_t *t, tlsf_block_t *b) {
+    int32_t fl, sl;
+    mapping_insert(block_size(b), &fl, &sl);
+    remove_free(t, b, fl, sl);
+}
+
+static void block_insert(tlsf_t *t, tlsf_block_t *b) {
+    int32_t fl, sl;
+    mapping_insert(block_size(b), &fl, &sl);
+    insert_free(t, b, fl, sl);
+}
+
+// split `b` so it holds exactly `size` bytes, the rest becomes a free block
+static void block_trim(tlsf_t *t, tlsf_block_t *b, uint64_t size) {
+    if (block_size(b) < size + sizeof(tlsf_block_t)) return;
+
+    tlsf_block_t *rest = (tlsf_block_t *)((uint8_t *)block_to_ptr(b) + size);
+    rest->size = 0;
+    block_set_size(rest, block_size(b) - size - BLOCK_HEADER);
+    block_set_size(b, size);
+
+    block_link_next(b);
+    block_mark_free(rest);
+    block_insert(t, rest);
+}
+
+static tlsf_block_t *block_merge_prev(tlsf_t *t, tlsf_block_t *b) {
+    if (b->size & BLOCK_PREV_FREE) {
+        tlsf_block_t *prev = b->prev_phys;
+        block_remove(t, prev);
+        block_set_size(prev, block_size(prev) + block_size(b) + BLOCK_HEADER);
+        block_link_next(prev);
+        b = prev;
+    }
+    return b;
+}
+
+static tlsf_block_t *block_merge_next(tlsf_t *t, tlsf_block_t *b) {
+    tlsf_block_t *next = block_next(b);
+    if (block_is_free(next)) {
+        block_remove(t, next);
+        block_set_size(b, block_size(b) + block_size(next) + BLOCK_HEADER);
+        block_link_next(b);
+    }
+    return b;
+}
+
+static INL uint64_t adjust_size(uint64_t size) {
+    uint64_t aligned = (size + (ALIGN_SIZE - 1)) & ~(ALIGN_SIZE - 1);
+    return MAX(aligned, BLOCK_MIN);
+}
+
+tlsf_t *tlsf_create(void *memory, uint64_t size) {
+    if (!memory) return NULL;
+
+    uintptr_t base = (uintptr_t)memory;
+    uintptr_t start = (base + sizeof(tlsf_t) + (ALIGN_SIZE - 1)) &
+                      ~(uintptr_t)(ALIGN_SIZE - 1);
+    uintptr_t end = (base + size) & ~(uintptr_t)(ALIGN_SIZE - 1);
+
+    // room for the first block header, its minimum payload and the sentinel
+    if (end < start + 2 * BLOCK_HEADER + BLOCK_MIN) {
+        LOG_ERROR("tlsf pool of %lu bytes is too small", size);
+        return NULL;
+    }
+
+    tlsf_t *t = memory;
+    memset(t, 0, sizeof(tlsf_t));
+    t->null_block.next_free = &t->null_block;
+    t->null_block.prev_free = &t->null_block;
+    for (uint32_t i = 0; i < FL_INDEX_COUNT; ++i) {
+        for (uint32_t j = 0; j < SL_INDEX_COUNT; ++j) {
+            t->blocks[i][j] = &t->null_block;
+        }
+    }
+
+    uint64_t payload = (uint64_t)(end - start) - 2 * BLOCK_HEADER;
+    if (payload > BLOCK_MAX - ALIGN_SIZE) payload = BLOCK_MAX - ALIGN_SIZE;
+
+    tlsf_block_t *b = (tlsf_block_t *)start;
+    b->prev_phys = NULL;
+    b->size = payload;
+    block_mark_free(b);
+    block_insert(t, b);
+
+    // zero sized used sentinel, stops merging past the end of the pool
+    tlsf_block_t *last = block_link_next(b);
+    last->size = BLOCK_PREV_FREE;
+
+    t->pool_start = (uint8_t *)start;
+    t->pool_end = (uint8_t *)last + BLOCK_HEADER;
+
+    return t;
+}
+
+void *tlsf_malloc(tlsf_t *t, uint64_t size) {
+    if (!t || size == 0 || size >= BLOCK_MAX) return NULL;
+
+    uint64_t adjusted = adjust_size(size);
+    int32_t fl, sl;
+    mapping_search(adjusted, &fl, &sl);
+    if (fl >= FL_INDEX_COUNT) return NULL;
+
+    tlsf_block_t *b = search_suitable(t, &fl, &sl);
+    if (!b || b == &t->null_block) return NULL;
+
+    remove_free(t, b, fl, sl);
+    block_trim(t, b, adjusted);
+    block_mark_used(b);
+
+    return block_to_ptr(b);
+}
+
+void tlsf_free(tlsf_t *t, void *ptr) {
+    if (!t || !ptr) return;
+
+    tlsf_block_t *b = block_from_ptr(ptr);
+    ASSERT(!block_is_free(b), "tlsf double free");
+
+    block_mark_free(b);
+    b = block_merge_prev(t, b);
+    b = block_merge_next(t, b);
+    block_mark_free(b);
+    block_insert(t, b);
+}
+
+bool tlsf_owns(const tlsf_t *t, const void *ptr) {
+    return t && (const uint8_t *)ptr >= t->pool_start &&
+           (const uint8_t *)ptr < t->pool_end;
+}
+
+uint64_t tlsf_block_size(const void *ptr) {
+    return ptr ? block_size(block_from_ptr(ptr)) : 0;
+}
+
+void tlsf_stats(const tlsf_t *t, tlsf_stat_t *out) {
+    memset(out, 0, sizeof(tlsf_stat_t));
+    if (!t) return;
+
+    const tlsf_block_t *b = (const tlsf_block_t *)t->pool_start;
+    while (!block_is_last(b)) {
+        uint64_t size = block_size(b);
+        out->total_size += size;
+        if (block_is_free(b)) {
+            out->free_size += size;
+            out->free_blocks++;
+            if (size > out->largest_free) out->largest_free = size;
+        } else {
+            out->used_size += size;
+            out->used_blocks++;
+        }
+        b = block_next(b);
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef TLSF_H
+#define TLSF_H
+
+#include "define.h"
+
+// Two-level segregated fit allocator over a caller-provided block of memory.
+// Allocation and free are O(1) in the worst case: the first level splits sizes
+// by power of two, the second level splits each range linearly, and two
+// bitmaps locate a non-empty free list without searching.
+typedef struct tlsf_t tlsf_t;
+
+typedef struct {
+    uint64_t total_size;
+    uint64_t used_size;
+    uint64_t free_size;
+    uint64_t largest_free;
+    uint32_t free_blocks;
+    uint32_t used_blocks;
+} tlsf_stat_t;
+
+tlsf_t *tlsf_create(void *memory, uint64_t size);
+
+void *tlsf_malloc(tlsf_t *tlsf, uint64_t size);
+void tlsf_free(tlsf_t *tlsf, void *ptr);
+
+bool tlsf_owns(const tlsf_t *tlsf, const void *ptr);
+uint64_t tlsf_block_size(const void *ptr);
+
+// walks every block, meant for debug output not the hot path
+void tlsf_stats(const tlsf_t *tlsf, tlsf_stat_t *out);
+
+#endif // TLSF_H
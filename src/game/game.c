@@ -15,6 +15,11 @@ game_system_t *game_init(void) {
 }
 
 bool game_update(game_system_t *game, float delta) {
+    if (!game->late_latch) game_update_camera(game, delta);
+    return true;
+}
+
+void game_update_camera(game_system_t *game, float delta) {
     float move_speed = 5.0f;
     if (key_press(INPUT_KEY_LEFT)) {
         cam_yaw(game->cam, move_speed * delta);
@@ -64,7 +69,6 @@ bool game_update(game_system_t *game, float delta) {
         game->cam->main_cam.dirty = true;
     }
     camera_update(game->cam);
-    return true;
 }
 
 bool game_render(game_system_t *game, float delta) {
@@ -75,7 +79,7 @@ bool game_render(game_system_t *game, float delta) {
 
 void game_kill(game_system_t *game) {
     if (game) {
-        WFREE(game, 0, sizeof(game_system_t));
+        WFREE(game, sizeof(game_system_t), MEM_GAME);
     }
     LOG_INFO("Goodbye WOMM!!");
 }
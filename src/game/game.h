@@ -11,12 +11,16 @@ typedef struct {
 
     bool is_running;
     bool is_suspend;
+    bool late_latch; // camera is moved by the renderer's latch, not update
+    bool on_demand;  // draw only when the camera or the scene changed
+    bool redraw;     // draw the next frame even if nothing changed
     double last_time;
     float delta;
 } game_system_t;
 
 game_system_t *game_init(void);
 bool game_update(game_system_t *game, float delta);
+void game_update_camera(game_system_t *game, float delta);
 bool game_render(game_system_t *game, float delta);
 void game_kill(game_system_t *game);
 
@@ -1,9 +1,14 @@
 #include "core/define.h"
 #include "core/event.h"
 #include "core/input.h"
+#include "core/latency.h"
 #include "core/memory.h"
+#include "core/pacer.h"
+#include "core/replay.h"
 #include "core/math/maths.h"
+#include "core/container/name.h"
 #include "platform/filesystem.h"
+#include "platform/vmem.h"
 #include "renderer/frontend.h"
 #include "module/geometry.h"
 #include "module/material.h"
@@ -11,18 +16,28 @@
 #include "game/game.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STEADY_STATE_WARMUP 120
+// longest an idle loop blocks before it looks around again
+#define IDLE_WAIT_TIME 0.5
 
 // for all module system
 typedef struct {
     arena_alloc_t persistent_arena;
-    arena_alloc_t frame_arena;
+    arena_alloc_t frame_arena[FRAME_FLIGHT];
 
     render_bundle_t bundle;
+    pacer_t pacer;
 
+    name_system_t *names;
     file_system_t *fs;
     window_system_t *window;
     event_system_t *event;
     input_system_t *input;
+    replay_t *replay;
+    latency_system_t *latency;
     camera_system_t *camera;
     render_system_t *render;
     geometry_system_t *geo;
@@ -33,6 +48,18 @@ typedef struct {
 
 static system_t g_system;
 
+// command line
+typedef struct {
+    replay_mode_t replay_mode;
+    const char *replay_path;
+    bool late_latch;
+    bool headless;
+    bool on_demand;
+    uint64_t max_frames; // 0 runs until quit
+    double fps;          // frame limit, 0 = none, < 0 picks the default
+    render_config_t render;
+} launch_args_t;
+
 bool game_on_input(event_system_t *event, uint32_t type, event_t *ev,
                    void *sender, void *recipient);
 bool game_on_event(event_system_t *event, uint32_t type, event_t *ev,
@@ -43,8 +70,10 @@ bool game_on_resize(event_system_t *event, uint32_t type, event_t *ev,
 #if DEBUG
 static void system_log(void) {
     LOG_DEBUG("=== Memory Addresses ===");
+    LOG_DEBUG("Names:     %p", g_system.names);
     LOG_DEBUG("Event:     %p", g_system.event);
     LOG_DEBUG("Input:     %p", g_system.input);
+    LOG_DEBUG("Latency:   %p", g_system.latency);
     LOG_DEBUG("Window:    %p", g_system.window);
     LOG_DEBUG("Camera:    %p", g_system.camera);
     LOG_DEBUG("Render:    %p", g_system.render);
@@ -53,21 +82,27 @@ static void system_log(void) {
     LOG_DEBUG("Material:  %p", g_system.mat);
 
     uint64_t used = arena_used(&g_system.persistent_arena);
-    uint64_t total = g_system.persistent_arena.total_size;
-    float usage_percent = (float)used / (float)total * 100.0f;
+    uint64_t committed = arena_committed(&g_system.persistent_arena);
+    uint64_t reserved = arena_reserved(&g_system.persistent_arena);
+    float usage_percent = (float)used / (float)committed * 100.0f;
 
-    LOG_DEBUG("Arena Usage: %lu/%lu bytes (%.1f%%)", used, total,
-              usage_percent);
+    LOG_DEBUG("Arena Usage: %lu/%lu bytes committed (%.1f%%), %lu reserved",
+              used, committed, usage_percent, reserved);
 
-    if (usage_percent < 50.0f) {
-        LOG_WARN("Wasted space! Arena is only %.1f%% used", usage_percent);
-    } else if (usage_percent > 90.0f) {
-        LOG_WARN("Arena nearly full! %.1f%% used", usage_percent);
+    if (g_system.persistent_arena.chain) {
+        LOG_WARN("Arena overflowed into %lu chained bytes",
+                 g_system.persistent_arena.chain_size);
     }
 }
 #endif
 
-static bool system_init(void) {
+// a worker posted an event, get the main loop out of its idle wait
+static void wake_main(void *user) {
+    (void)user;
+    window_system_wake(g_system.window);
+}
+
+static bool system_init(const launch_args_t *args) {
     // set memory system allocation 10Mb
     uint64_t estimated_memory = 10 * 1024 * 1024;
     if (!memory_system_init(estimated_memory)) {
@@ -76,23 +111,50 @@ static bool system_init(void) {
         return false;
     }
 
-    arena_create(16 * 1024, &g_system.persistent_arena, NULL);
-    arena_create(8 * 1024, &g_system.frame_arena, NULL);
+    if (!memory_heap_init(256 * 1024 * 1024)) {
+        LOG_WARN("Engine heap unavailable, using system allocator");
+    }
+    memory_set_budget(MEM_RESOURCE, 128 * 1024 * 1024);
+    memory_set_budget(MEM_TEXTURE, 16 * 1024 * 1024);
+
+    // address space is cheap, pages are committed only when touched
+    if (!arena_create_ex(64 * 1024 * 1024, ARENA_VIRTUAL | ARENA_CHAINED,
+                         &g_system.persistent_arena)) {
+        LOG_ERROR("Failed to create persistent arena");
+        return false;
+    }
+
+    // one frame arena per frame in flight, recycled after its fence signals.
+    // prefaulted so the first frames don't pay for page faults
+    for (uint32_t i = 0; i < FRAME_FLIGHT; ++i) {
+        if (!arena_create_ex(4 * 1024 * 1024,
+                             ARENA_CHAINED | ARENA_HUGE_PAGES | ARENA_PREFAULT,
+                             &g_system.frame_arena[i])) {
+            LOG_ERROR("Failed to create frame arena %u", i);
+            return false;
+        }
+    }
 
     window_config_t config = {.name = "WOMM",
                               .width = 800,
                               .height = 600,
-                              .is_resizeable = true};
+                              .is_resizeable = true,
+                              .headless = args->headless};
 
+    g_system.names = name_system_init(&g_system.persistent_arena);
     g_system.fs = filesys_init(&g_system.persistent_arena);
     g_system.event = event_system_init(&g_system.persistent_arena);
     g_system.input = input_system_init(&g_system.persistent_arena);
+    g_system.latency = latency_system_init(&g_system.persistent_arena);
+    g_system.replay = replay_init(&g_system.persistent_arena, g_system.event,
+                                  args->replay_mode, args->replay_path);
 
     g_system.window = window_system_init(config, &g_system.persistent_arena);
     g_system.camera = camera_system_init(&g_system.persistent_arena,
                                          &g_system.window->native_win);
     g_system.render = render_system_init(&g_system.persistent_arena,
-                                         &g_system.window->native_win);
+                                         &g_system.window->native_win,
+                                         args->render);
 
     g_system.geo = geo_system_init(&g_system.persistent_arena);
     g_system.tex = texture_system_init(&g_system.persistent_arena);
@@ -102,24 +164,50 @@ static bool system_init(void) {
     // bundle initialize
     g_system.bundle.delta = g_system.game->delta;
 
+    // heap backed, the scene list grows as objects are added
+    if (!object_list_init(&g_system.bundle.obj, NULL, 16)) {
+        LOG_ERROR("Failed to allocate render bundle");
+        return false;
+    }
+
     // TODO: all of this was temporary code!!!
-    g_system.bundle.obj[0].geo = &g_system.geo->default_geo;
-    g_system.bundle.obj[0].model = mat4_identity();
-    g_system.bundle.obj[0].material.diffuse_color =
-        (vec4){{1.0f, 1.0f, 1.0f, 1.0f}};
-    g_system.bundle.obj[0].material.tex = &g_system.tex->gear_base;
-    g_system.bundle.obj_count = 1;
+    object_bundle_t *obj = object_list_push_zero(&g_system.bundle.obj);
+    obj->geo = geo_get(g_system.geo, NAME("default_cube"));
+    obj->model = mat4_identity();
+    obj->material.diffuse_color = (vec4){{1.0f, 1.0f, 1.0f, 1.0f}};
+    obj->material.tex = texture_load(g_system.tex, "textures/test");
+    g_system.bundle.revision++;
 
 #if DEBUG
     system_log();
 #endif
 
+    // input bursts and resizes are batched and delivered once per frame,
+    // quit/suspend/resume still go out as soon as they are pushed
+    event_set_mode(g_system.event, EVENT_KEY_PRESS, EVENT_MODE_QUEUED);
+    event_set_mode(g_system.event, EVENT_KEY_RELEASE, EVENT_MODE_QUEUED);
+    event_set_mode(g_system.event, EVENT_MOUSE_PRESS, EVENT_MODE_QUEUED);
+    event_set_mode(g_system.event, EVENT_MOUSE_RELEASE, EVENT_MODE_QUEUED);
+    event_set_mode(g_system.event, EVENT_MOUSE_MOVE, EVENT_MODE_QUEUED);
+    event_set_mode(g_system.event, EVENT_MOUSE_WHEEL, EVENT_MODE_QUEUED);
+    event_set_mode(g_system.event, EVENT_MOUSE_RAW, EVENT_MODE_QUEUED);
+    event_set_mode(g_system.event, EVENT_RESIZE, EVENT_MODE_QUEUED);
+
+    // one event per frame is enough for motion, resize and held keys
+    event_set_coalesce(g_system.event, EVENT_MOUSE_MOVE,
+                       EVENT_COALESCE_ACCUMULATE);
+    event_set_coalesce(g_system.event, EVENT_MOUSE_RAW,
+                       EVENT_COALESCE_ACCUMULATE);
+    event_set_coalesce(g_system.event, EVENT_RESIZE, EVENT_COALESCE_LAST);
+    event_set_coalesce(g_system.event, EVENT_KEY_PRESS, EVENT_COALESCE_REPEAT);
+
     event_reg(g_system.event, EVENT_QUIT, game_on_event, NULL);
     event_reg(g_system.event, EVENT_SUSPEND, game_on_event, NULL);
     event_reg(g_system.event, EVENT_RESUME, game_on_event, NULL);
     event_reg(g_system.event, EVENT_RESIZE, game_on_resize, NULL);
     event_reg(g_system.event, EVENT_KEY_PRESS, game_on_input, NULL);
     event_reg(g_system.event, EVENT_KEY_RELEASE, game_on_input, NULL);
+    event_set_waker(g_system.event, wake_main, NULL);
 
     return true;
 }
@@ -134,28 +222,133 @@ static void system_kill(void) {
     event_unreg(g_system.event, EVENT_KEY_PRESS, game_on_input, NULL);
     event_unreg(g_system.event, EVENT_KEY_RELEASE, game_on_input, NULL);
 
+    object_list_kill(&g_system.bundle.obj);
     material_system_kill(g_system.mat);
     texture_system_kill(g_system.tex);
     geo_system_kill(g_system.geo);
     render_system_kill(g_system.render);
     camera_system_kill(g_system.camera);
     window_system_kill(g_system.window);
+    replay_kill(g_system.replay);
+    latency_system_kill(g_system.latency);
     input_system_kill(g_system.input);
     event_system_kill(g_system.event);
     filesys_kill(g_system.fs);
+    name_system_kill(g_system.names);
 
-    arena_kill(&g_system.frame_arena);
+    for (uint32_t i = 0; i < FRAME_FLIGHT; ++i) {
+        LOG_DEBUG("Frame arena %u peak: %lu bytes", i,
+                  g_system.frame_arena[i].high_water);
+        arena_kill(&g_system.frame_arena[i]);
+    }
     arena_kill(&g_system.persistent_arena);
 
     game_kill(g_system.game);
+#if DEBUG
+    mem_profile_dump("mem_profile.csv");
+#endif
     memory_system_kill();
 }
 
-int main(void) {
-    system_init();
+// just before submit: take whatever input arrived while the frame was being
+// recorded and move the camera with it
+static void late_latch(void *user) {
+    (void)user;
+    if (!window_system_pump(g_system.window, g_system.input, g_system.event)) {
+        g_system.game->is_running = false;
+    }
+    latency_frame_begin();
+    game_update_camera(g_system.game, g_system.game->delta);
+}
+
+// Block on the X connection (or a worker's wake) instead of spinning. Time
+// spent blocked is not game time, keep it out of the next delta.
+static void idle_wait(void) {
+    window_system_wait(g_system.window, IDLE_WAIT_TIME);
+    timer_update(&g_system.game->timer);
+    g_system.game->last_time = g_system.game->timer.elapsed;
+    pacer_resync(&g_system.pacer);
+}
+
+static bool parse_present(const char *str, render_present_t *out) {
+    static const char *names[RENDER_PRESENT_MAX] = {"fifo", "relaxed",
+                                                    "mailbox", "immediate"};
+    for (uint32_t i = 0; i < RENDER_PRESENT_MAX; ++i) {
+        if (strcmp(str, names[i]) == 0) {
+            *out = (render_present_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// --record <file> captures input, --replay <file> plays it back,
+// --late-latch samples the camera at submit time, --headless renders
+// offscreen without a display, --frames <n> quits after n frames,
+// --on-demand only draws when the camera or the scene changed,
+// --present <fifo|relaxed|mailbox|immediate> and --images <n> set up the
+// swapchain, --fps <n> caps the frame rate (0 = uncapped)
+static void parse_args(int argc, char **argv, launch_args_t *args) {
+    memset(args, 0, sizeof(launch_args_t));
+    args->fps = -1.0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            args->replay_mode = REPLAY_RECORD;
+            args->replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            args->replay_mode = REPLAY_PLAY;
+            args->replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--late-latch") == 0) {
+            args->late_latch = true;
+        } else if (strcmp(argv[i], "--headless") == 0) {
+            args->headless = true;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            args->max_frames = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--on-demand") == 0) {
+            args->on_demand = true;
+        } else if (strcmp(argv[i], "--present") == 0 && i + 1 < argc) {
+            if (!parse_present(argv[++i], &args->render.present)) {
+                LOG_WARN("unknown present mode '%s', using fifo", argv[i]);
+            }
+        } else if (strcmp(argv[i], "--images") == 0 && i + 1 < argc) {
+            args->render.image_count =
+                (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            args->fps = strtod(argv[++i], NULL);
+        } else {
+            LOG_WARN("unknown argument '%s'", argv[i]);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    launch_args_t args;
+    parse_args(argc, argv, &args);
+
+    system_init(&args);
+    if (args.late_latch && args.replay_mode != REPLAY_OFF) {
+        // the latch pumps input mid-draw, outside what the recording sees
+        LOG_WARN("--late-latch ignored with --record or --replay");
+        args.late_latch = false;
+    }
+    if (args.late_latch) {
+        g_system.game->late_latch = true;
+        render_system_set_late_latch(g_system.render, late_latch, NULL);
+    }
+    if (args.on_demand) {
+        // the latched camera only moves inside a draw, and a headless run
+        // has nobody to wake it
+        if (args.late_latch || args.headless) {
+            LOG_WARN("--on-demand ignored with --late-latch or --headless");
+        } else {
+            g_system.game->on_demand = true;
+            g_system.game->redraw = true;
+        }
+    }
 
-    const double TARGET_FPS = 60.0;
-    const double TARGET_FRAME_TIME = 1.0 / TARGET_FPS;
+    // headless runs are benchmarks, let them go as fast as they can
+    double fps = args.fps;
+    if (fps < 0.0) fps = args.headless ? 0.0 : 60.0;
 
     g_system.game->is_running = true;
     timer_start(&g_system.game->timer);
@@ -164,29 +357,64 @@ int main(void) {
 
     double runtime = 0;
     uint8_t frame_count = 0;
-    const bool limit = true;
+    uint64_t total_frames = 0;
+    uint32_t drawn_cam = 0;
+    uint32_t drawn_bundle = 0;
 
     LOG_INFO("%s", mem_debug_stat());
     LOG_INFO("%s", vram_status(g_system.render));
 
+    // steady state must not touch the heap once the first frames are done
+    memory_frame_watch(STEADY_STATE_WARMUP, false);
+
+    pacer_init(&g_system.pacer, fps);
     while (g_system.game->is_running) {
-        if (!window_system_pump(g_system.window, g_system.input,
-                                g_system.event)) {
+        // unmapped or zero sized, nothing to do until the X server says so
+        if (g_system.game->is_suspend && !replay_is_playing(g_system.replay)) {
+            idle_wait();
+        }
+
+        if (replay_is_playing(g_system.replay)) {
+            // the recording stands in for the keyboard and mouse
+            if (!replay_pump(g_system.replay, g_system.input,
+                             g_system.event)) {
+                g_system.game->is_running = false;
+            }
+        } else if (!window_system_pump(g_system.window, g_system.input,
+                                       g_system.event)) {
             g_system.game->is_running = false;
         };
+        event_dispatch_all(g_system.event);
 
         if (!g_system.game->is_suspend) {
             timer_update(&g_system.game->timer);
             double curr_time = g_system.game->timer.elapsed;
             g_system.game->delta =
                 (float)(curr_time - g_system.game->last_time);
+            if (replay_is_playing(g_system.replay)) {
+                g_system.game->delta = replay_delta(g_system.replay);
+            }
 
             g_system.game->last_time = curr_time;
             double frame_time_start = get_abs_time();
 
+            // the slot's fence has signaled, nothing on the GPU still reads
+            // the data this frame arena handed out last time around
+            uint32_t slot = render_system_wait_frame(g_system.render);
+            arena_alloc_t *frame_arena = &g_system.frame_arena[slot];
+            if (frame_arena->overflow_count) {
+                LOG_WARN("Frame arena %u overflowed %u times (%lu bytes)",
+                         slot, frame_arena->overflow_count,
+                         arena_used(frame_arena));
+            }
+            arena_reset(frame_arena);
+
+            memory_frame_begin();
             input_system_update(g_system.input, g_system.game->delta,
-                                &g_system.frame_arena);
+                                frame_arena);
 
+            // input pumped so far is what this frame reacts to
+            latency_frame_begin();
             if (!game_update(g_system.game, g_system.game->delta)) {
                 g_system.game->is_running = false;
                 break;
@@ -196,24 +424,66 @@ int main(void) {
                 break;
             }
 
-            render_system_draw(g_system.render, &g_system.bundle);
+            // before the draw: input a late latch pumps belongs to the next
+            // frame's edges
+            input_frame_end(g_system.input);
+
+            bool draw = true;
+            if (g_system.game->on_demand) {
+                const camera_t *cam = &g_system.camera->main_cam;
+                draw = g_system.game->redraw || cam->revision != drawn_cam ||
+                       g_system.bundle.revision != drawn_bundle ||
+                       window_system_pump_stats(g_system.window).exposes;
+            }
+            if (draw && render_system_draw(g_system.render, &g_system.bundle)) {
+                drawn_cam = g_system.camera->main_cam.revision;
+                drawn_bundle = g_system.bundle.revision;
+                g_system.game->redraw = false;
+                frame_count++;
+            }
+            memory_frame_end();
 
-            double next_frame_time = frame_time_start + TARGET_FRAME_TIME;
             double frame_time_end = get_abs_time();
             double frame_elapsed = frame_time_end - frame_time_start;
             runtime += frame_elapsed;
+            replay_end_frame(g_system.replay, frame_elapsed);
 
-            if (limit && frame_time_end < next_frame_time) {
-                get_sleep(next_frame_time);
+            if (!draw && !replay_is_playing(g_system.replay)) {
+                idle_wait();
+            } else {
+                pacer_wait(&g_system.pacer);
+            }
+            if (args.max_frames && ++total_frames >= args.max_frames) {
+                g_system.game->is_running = false;
             }
-            frame_count++;
 
 #if DEBUG
             static double fps_timer = 0.0;
+            static double worst_frame = 0.0;
+            static uint64_t last_faults = 0;
+            static uint32_t merged_events = 0;
+            static double worst_pump = 0.0;
             fps_timer += g_system.game->delta;
+            worst_frame = MAX(worst_frame, frame_elapsed);
+            merged_events += event_frame_stats(g_system.event).merged;
+            worst_pump = MAX(worst_pump,
+                             window_system_pump_stats(g_system.window).time);
 
             if (fps_timer >= 1.0) {
-                printf("FPS: %d\n", frame_count);
+                uint64_t minor, major;
+                vmem_fault_count(&minor, &major);
+                latency_stats_t lat = latency_stats(LATENCY_PRESENT);
+                pacer_stats_t pace = pacer_take_recent(&g_system.pacer);
+                printf("FPS: %d, worst %.2fms, interval %.2f+-%.2fms, %lu "
+                       "page faults, %u events merged, worst pump %.0fus, "
+                       "input->present p50 %.1fms p99 %.1fms\n",
+                       frame_count, worst_frame * 1000.0, pace.mean,
+                       pace.stddev, minor + major - last_faults,
+                       merged_events, worst_pump * 1e6, lat.p50, lat.p99);
+                last_faults = minor + major;
+                merged_events = 0;
+                worst_pump = 0.0;
+                worst_frame = 0.0;
                 frame_count = 0;
                 fps_timer = 0.0;
             }
@@ -222,6 +492,12 @@ int main(void) {
         }
     }
 
+    pacer_stats_t pace = pacer_total(&g_system.pacer);
+    LOG_INFO("frame interval %.3fms mean, %.3fms stddev, %.3fms worst over "
+             "%lu frames, %lu missed deadlines",
+             pace.mean, pace.stddev, pace.worst, pace.frames,
+             g_system.pacer.missed);
+
     system_kill();
     return 0;
 }
@@ -236,6 +512,8 @@ bool game_on_input(event_system_t *event, uint32_t type, event_t *ev,
             event_t evquit = {};
             event_push(event, EVENT_QUIT, &evquit, NULL);
             return true;
+        } else if (kc == INPUT_KEY_F9) {
+            mem_profile_dump("mem_profile.json");
         } else {
             // LOG_DEBUG("'%s' pressed in window", keycode_to_str(kc));
         }
@@ -268,6 +546,7 @@ bool game_on_event(event_system_t *event, uint32_t type, event_t *ev,
             LOG_INFO("EVENT_RESUME received. Resume...");
             g_system.game->is_suspend = false;
             g_system.game->is_running = true;
+            g_system.game->redraw = true;
             return true;
         } break;
     }
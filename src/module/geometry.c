@@ -1,6 +1,7 @@
 #include "geometry.h"
 #include "core/memory.h"
 #include "renderer/frontend.h"
+#include "platform/thread.h"
 
 #include <string.h>
 
@@ -16,6 +17,9 @@ geometry_system_t *geo_system_init(arena_alloc_t *arena) {
 
     memset(geo, 0, sizeof(geometry_system_t));
     geo->arena = arena;
+    geo->geometries = arena_alloc(arena, sizeof(geo_gpu_t) * MAX_GEOMETRY);
+    if (!geo->geometries) return NULL;
+    if (!cmap_create(&geo->lookup, arena, MAX_GEOMETRY)) return NULL;
 
     default_geo_init(geo);
     LOG_INFO("geometry system initialized");
@@ -23,10 +27,41 @@ geometry_system_t *geo_system_init(arena_alloc_t *arena) {
 }
 
 void geo_system_kill(geometry_system_t *geo) {
-    if (geo) memset(geo, 0, sizeof(geometry_system_t));
+    if (geo) {
+        cmap_kill(&geo->lookup);
+        memset(geo, 0, sizeof(geometry_system_t));
+    }
     LOG_INFO("geometry system kill");
 }
 
+geo_gpu_t *geo_get(geometry_system_t *geo, name_id_t name) {
+    return cmap_get(&geo->lookup, name);
+}
+
+// runs under the lookup stripe lock
+static void *claim_slot(uint64_t key, void *user) {
+    (void)key;
+    geometry_system_t *geo = user;
+
+    uint32_t index = ATOMIC_ADD(&geo->geo_count, 1);
+    if (index >= MAX_GEOMETRY) {
+        ATOMIC_SUB(&geo->geo_count, 1);
+        return NULL;
+    }
+
+    memset(&geo->geometries[index], 0, sizeof(geo_gpu_t));
+    return &geo->geometries[index];
+}
+
+geo_gpu_t *geo_register(geometry_system_t *geo, name_id_t name) {
+    geo_gpu_t *slot =
+        cmap_get_or_create(&geo->lookup, name, claim_slot, NULL, geo, NULL);
+    if (!slot) {
+        LOG_WARN("geometry registry full, '%s' dropped", name_str(name));
+    }
+    return slot;
+}
+
 geo_cpu_t geo_create_plane(float width, float height, uint32_t seg_x,
                            uint32_t seg_y) {
     if (width == 0) {
@@ -440,7 +475,10 @@ bool default_geo_init(geometry_system_t *geo) {
                   vert_3d[i].normal.comp1.z);
     }
 
-    render_geo_init(&geo->default_geo, sizeof(vertex_3d), 24, vert_3d,
-                    sizeof(uint32_t), 36, indices);
+    geo_gpu_t *cube = geo_register(geo, NAME("default_cube"));
+    if (!cube) return false;
+
+    render_geo_init(cube, sizeof(vertex_3d), 24, vert_3d, sizeof(uint32_t), 36,
+                    indices);
     return true;
 }
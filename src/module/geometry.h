@@ -3,16 +3,24 @@
 
 #include "core/define.h" // IWYU pragma: keep
 #include "core/arena.h"
+#include "core/container/cmap.h"
 #include "renderer/frontend_type.h"
 
+#define MAX_GEOMETRY 64
+
 typedef struct {
     arena_alloc_t *arena;
-    geo_gpu_t default_geo;
+    cmap_t lookup; // name id -> slot in geometries
+    geo_gpu_t *geometries;
+    uint32_t geo_count;
 } geometry_system_t;
 
 geometry_system_t *geo_system_init(arena_alloc_t *arena);
 void geo_system_kill(geometry_system_t *geo);
 
+geo_gpu_t *geo_register(geometry_system_t *geo, name_id_t name);
+geo_gpu_t *geo_get(geometry_system_t *geo, name_id_t name);
+
 geo_cpu_t geo_create_plane(float width, float height, uint32_t seg_x,
                            uint32_t seg_y);
 
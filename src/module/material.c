@@ -10,6 +10,10 @@ material_system_t *material_system_init(arena_alloc_t *arena) {
     memset(mat, 0, sizeof(material_system_t));
 
     mat->arena = arena;
+    mat->materials =
+        arena_alloc(arena, sizeof(material_data_t) * MAX_MATERIALS);
+    if (!mat->materials) return NULL;
+
     default_material_init(mat);
 
     LOG_INFO("material system init");
@@ -22,8 +26,34 @@ void material_system_kill(material_system_t *mat) {
 }
 
 bool default_material_init(material_system_t *mat) {
-    // strcpy(mat->default_mat.name, "default");
+    mat->default_mat.name = NAME("default");
     mat->default_mat.diffuse_color = (vec4){{0.5f, 0.5f, 0.5f, 1.0f}};
     mat->default_mat.has_texture = false;
-    return true;
+    return material_register(mat, &mat->default_mat) != NULL;
+}
+
+material_data_t *material_register(material_system_t *mat,
+                                   const material_data_t *data) {
+    material_data_t *found = material_get(mat, data->name);
+    if (found) {
+        *found = *data;
+        return found;
+    }
+
+    if (mat->material_count == MAX_MATERIALS) {
+        LOG_WARN("material registry full, '%s' dropped",
+                 name_str(data->name));
+        return NULL;
+    }
+
+    material_data_t *out = &mat->materials[mat->material_count++];
+    *out = *data;
+    return out;
+}
+
+material_data_t *material_get(material_system_t *mat, name_id_t name) {
+    for (uint32_t i = 0; i < mat->material_count; ++i) {
+        if (mat->materials[i].name == name) return &mat->materials[i];
+    }
+    return NULL;
 }
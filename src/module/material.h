@@ -5,12 +5,20 @@
 #include "core/arena.h"
 #include "renderer/frontend_type.h"
 
+#define MAX_MATERIALS 64
+
 typedef struct {
     arena_alloc_t *arena;
     material_data_t default_mat;
+    material_data_t *materials; // registry, keyed by name id
+    uint32_t material_count;
 } material_system_t;
 
 material_system_t *material_system_init(arena_alloc_t *arena);
 void material_system_kill(material_system_t *mat);
 
+material_data_t *material_register(material_system_t *mat,
+                                   const material_data_t *data);
+material_data_t *material_get(material_system_t *mat, name_id_t name);
+
 #endif // MATERIAL_H
@@ -1,6 +1,7 @@
 #include "texture.h"
 #include "renderer/frontend.h"
 #include "core/binary_loader.h"
+#include "platform/thread.h"
 
 #include <string.h>
 
@@ -31,7 +32,7 @@ static bool default_tex_init(texture_data_t *tex) {
         }
     }
 
-    strcpy(tex->name, "default_checker");
+    tex->name = NAME("default_checker");
     tex->width = dimension;
     tex->height = dimension;
     tex->channels = channel;
@@ -42,21 +43,19 @@ static bool default_tex_init(texture_data_t *tex) {
 
 static void default_tex_kill(texture_data_t *tex) {
     render_tex_kill(tex);
-
-    memset(tex->name, 0, sizeof(char) * 64);
     memset(tex, 0, sizeof(texture_data_t));
 }
 
-static bool load_from_file(texture_system_t *tex, const char *name,
+static bool load_from_file(texture_system_t *tex, name_id_t name,
                            texture_data_t *out_tex) {
     (void)tex;
     char path[MAX_PATH];
-    snprintf(path, sizeof(path), "%s.png", name);
+    snprintf(path, sizeof(path), "%s.png", name_str(name));
 
     int32_t width, height, channels;
 
     void *pixel = read_image_file(path, &width, &height, &channels);
-    strcpy(out_tex->name, name);
+    out_tex->name = name;
     out_tex->width = (uint32_t)width;
     out_tex->height = (uint32_t)height;
     out_tex->channels = (uint32_t)channels;
@@ -75,17 +74,40 @@ static bool load_from_file(texture_system_t *tex, const char *name,
 }
 
 static bool load_womm_tex(texture_system_t *tex) {
-    bool loaded = true;
-    if (!load_from_file(tex, "textures/test", &tex->gear_base)) {
-        tex->gear_base = tex->default_texture;
-        LOG_WARN("texture not found. fallback!");
-        loaded = false;
+    return texture_load(tex, "textures/test") != &tex->default_texture;
+}
+
+static void unload_textures(texture_system_t *tex) {
+    for (uint32_t i = 0; i < tex->texture_count; ++i) {
+        if (tex->states[i] == TEXTURE_READY) render_tex_kill(&tex->textures[i]);
+    }
+    tex->texture_count = 0;
+}
+
+// runs under the lookup stripe lock, only claims the slot
+static void *claim_slot(uint64_t key, void *user) {
+    texture_system_t *tex = user;
+
+    uint32_t index = ATOMIC_ADD(&tex->texture_count, 1);
+    if (index >= MAX_TEXTURES) {
+        ATOMIC_SUB(&tex->texture_count, 1);
+        return NULL;
     }
-    return loaded;
+
+    memset(&tex->textures[index], 0, sizeof(texture_data_t));
+    tex->textures[index].name = (name_id_t)key;
+    ATOMIC_STORE(&tex->states[index], TEXTURE_LOADING);
+    return &tex->textures[index];
 }
 
-static void unload_womm_tex(texture_system_t *tex) {
-    render_tex_kill(&tex->gear_base);
+static INL uint32_t *slot_state(texture_system_t *tex, texture_data_t *slot) {
+    return &tex->states[slot - tex->textures];
+}
+
+// the lookup couldn't store it, nobody will load it: never leave it LOADING
+static void drop_slot(uint64_t key, void *value, void *user) {
+    (void)key;
+    ATOMIC_STORE_REL(slot_state(user, value), TEXTURE_FAILED);
 }
 
 texture_system_t *texture_system_init(arena_alloc_t *arena) {
@@ -94,6 +116,10 @@ texture_system_t *texture_system_init(arena_alloc_t *arena) {
     memset(tex, 0, sizeof(texture_system_t));
 
     tex->arena = arena;
+    tex->textures = arena_alloc(arena, sizeof(texture_data_t) * MAX_TEXTURES);
+    tex->states = arena_alloc(arena, sizeof(uint32_t) * MAX_TEXTURES);
+    if (!tex->textures || !tex->states) return NULL;
+    if (!cmap_create(&tex->lookup, arena, MAX_TEXTURES)) return NULL;
 
     if (!default_tex_init(&tex->default_texture)) {
         LOG_ERROR("failed to create default texture");
@@ -108,9 +134,51 @@ texture_system_t *texture_system_init(arena_alloc_t *arena) {
 
 void texture_system_kill(texture_system_t *tex) {
     if (tex) {
-        unload_womm_tex(tex);
+        uint64_t acquired, contended;
+        cmap_lock_stats(&tex->lookup, &acquired, &contended);
+        LOG_DEBUG("texture registry: %u slots, %lu lookups (%lu contended)",
+                  tex->texture_count, acquired, contended);
+
+        unload_textures(tex);
+        cmap_kill(&tex->lookup);
         default_tex_kill(&tex->default_texture);
         memset(tex, 0, sizeof(texture_system_t));
     }
     LOG_INFO("texture system kill");
 }
+
+texture_data_t *texture_get(texture_system_t *tex, name_id_t name) {
+    texture_data_t *slot = cmap_get(&tex->lookup, name);
+    if (!slot || ATOMIC_LOAD_ACQ(slot_state(tex, slot)) != TEXTURE_READY) {
+        return NULL;
+    }
+    return slot;
+}
+
+texture_data_t *texture_load(texture_system_t *tex, const char *filename) {
+    name_id_t name = NAME(filename);
+
+    bool inserted = false;
+    texture_data_t *slot =
+        cmap_get_or_create(&tex->lookup, name, claim_slot, drop_slot, tex,
+                           &inserted);
+    if (!slot) {
+        LOG_WARN("texture registry full, '%s' uses default", filename);
+        return &tex->default_texture;
+    }
+
+    uint32_t *state = slot_state(tex, slot);
+    if (inserted) {
+        // the file is read outside the lookup lock
+        bool loaded = load_from_file(tex, name, slot);
+        ATOMIC_STORE_REL(state, loaded ? TEXTURE_READY : TEXTURE_FAILED);
+        if (!loaded) LOG_WARN("texture '%s' not found. fallback!", filename);
+    } else {
+        while (ATOMIC_LOAD_ACQ(state) == TEXTURE_LOADING) {
+            thread_yield();
+        }
+    }
+
+    return ATOMIC_LOAD_ACQ(state) == TEXTURE_READY ? slot
+                                                   : &tex->default_texture;
+}
@@ -3,19 +3,33 @@
 
 #include "core/define.h" // IWYU pragma: keep
 #include "core/arena.h"
+#include "core/container/cmap.h"
 #include "renderer/frontend_type.h"
 
+#define MAX_TEXTURES 64
+
+typedef enum {
+    TEXTURE_LOADING = 1,
+    TEXTURE_READY,
+    TEXTURE_FAILED
+} texture_state_t;
+
 typedef struct {
     arena_alloc_t *arena;
-    texture_data_t *textures;
+    cmap_t lookup;            // name id -> slot in textures
+    texture_data_t *textures; // slots, claimed in load order
+    uint32_t *states;         // texture_state_t per slot
     uint32_t texture_count;
     texture_data_t default_texture;
-    texture_data_t gear_base;
 } texture_system_t;
 
 texture_system_t *texture_system_init(arena_alloc_t *arena);
 void texture_system_kill(texture_system_t *tex);
 
+// Safe to call from several threads, concurrent requests for the same file
+// share one load and the losers wait for it. Decoding runs in parallel, the
+// GPU upload goes through the renderer's upload lock one at a time.
 texture_data_t *texture_load(texture_system_t *tex, const char *filename);
+texture_data_t *texture_get(texture_system_t *tex, name_id_t name);
 
 #endif // TEXTURE_H
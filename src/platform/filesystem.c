@@ -150,3 +150,10 @@ bool filesys_read_all_binary(file_t *handle, uint8_t *out_byte,
     }
     return false;
 }
+
+bool filesys_write(file_t *handle, const void *data, uint64_t size) {
+    if (handle->handle && data) {
+        return fwrite(data, 1, size, (FILE *)handle->handle) == size;
+    }
+    return false;
+}
@@ -34,5 +34,6 @@ bool filesys_size(file_t *handle, uint64_t *size);
 bool filesys_read_all_text(file_t *handle, char *text, uint64_t *out_read);
 bool filesys_read_all_binary(file_t *handle, uint8_t *out_byte,
                              uint64_t *out_read);
+bool filesys_write(file_t *handle, const void *data, uint64_t size);
 
 #endif // FILESYSTEM_H
@@ -0,0 +1,33 @@
+#include "thread.h"
+#if PLATFORM_LINUX
+#    include <sched.h>
+
+bool mutex_create(mutex_t *mutex) {
+    if (pthread_mutex_init(&mutex->handle, NULL) != 0) {
+        LOG_ERROR("failed to create mutex");
+        return false;
+    }
+    return true;
+}
+
+void mutex_kill(mutex_t *mutex) {
+    pthread_mutex_destroy(&mutex->handle);
+}
+
+void mutex_lock(mutex_t *mutex) {
+    pthread_mutex_lock(&mutex->handle);
+}
+
+bool mutex_trylock(mutex_t *mutex) {
+    return pthread_mutex_trylock(&mutex->handle) == 0;
+}
+
+void mutex_unlock(mutex_t *mutex) {
+    pthread_mutex_unlock(&mutex->handle);
+}
+
+void thread_yield(void) {
+    sched_yield();
+}
+
+#endif
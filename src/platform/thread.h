@@ -0,0 +1,43 @@
+#ifndef THREAD_H
+#define THREAD_H
+
+#include "core/define.h"
+
+#if PLATFORM_LINUX
+#    include <pthread.h>
+typedef struct {
+    pthread_mutex_t handle;
+} mutex_t;
+#endif
+
+bool mutex_create(mutex_t *mutex);
+void mutex_kill(mutex_t *mutex);
+
+void mutex_lock(mutex_t *mutex);
+bool mutex_trylock(mutex_t *mutex);
+void mutex_unlock(mutex_t *mutex);
+
+void thread_yield(void);
+
+// busy-wait hint, eases off the core's pipeline and its sibling thread
+#if defined(__x86_64__) || defined(__i386__)
+#    define CPU_RELAX() __builtin_ia32_pause()
+#else
+#    define CPU_RELAX() ((void)0)
+#endif
+
+// Relaxed atomics for statistics and counters, no ordering is implied.
+#define ATOMIC_LOAD(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+#define ATOMIC_STORE(ptr, v) __atomic_store_n(ptr, v, __ATOMIC_RELAXED)
+#define ATOMIC_ADD(ptr, v) __atomic_fetch_add(ptr, v, __ATOMIC_RELAXED)
+#define ATOMIC_SUB(ptr, v) __atomic_fetch_sub(ptr, v, __ATOMIC_RELAXED)
+
+// Publish/consume pairs for data handed between threads.
+#define ATOMIC_LOAD_ACQ(ptr) __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#define ATOMIC_STORE_REL(ptr, v) __atomic_store_n(ptr, v, __ATOMIC_RELEASE)
+// weak CAS, on failure `*expected` is refreshed with the current value
+#define ATOMIC_CAS(ptr, expected, desired)                                     \
+    __atomic_compare_exchange_n(ptr, expected, desired, true,                  \
+                                __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)
+
+#endif // THREAD_H
@@ -0,0 +1,105 @@
+#define _DEFAULT_SOURCE
+#include "vmem.h"
+#if PLATFORM_LINUX
+#    include <sys/mman.h>
+#    include <sys/resource.h>
+#    include <unistd.h>
+
+#    define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+#    ifndef MADV_POPULATE_WRITE
+#        define MADV_POPULATE_WRITE 23
+#    endif
+
+uint64_t vmem_page_size(void) {
+    static uint64_t page_size = 0;
+    if (!page_size) {
+        long size = sysconf(_SC_PAGESIZE);
+        page_size = size > 0 ? (uint64_t)size : 4096;
+    }
+    return page_size;
+}
+
+uint64_t vmem_huge_page_size(void) {
+    return HUGE_PAGE_SIZE;
+}
+
+void *vmem_reserve(uint64_t size) {
+    void *addr = mmap(NULL, size, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (addr == MAP_FAILED) {
+        LOG_ERROR("failed to reserve %lu bytes of address space", size);
+        return NULL;
+    }
+    return addr;
+}
+
+void *vmem_reserve_huge(uint64_t size, vmem_huge_t *out_huge) {
+    *out_huge = VMEM_HUGE_NONE;
+
+#    ifdef MAP_HUGETLB
+    void *addr = mmap(NULL, size, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (addr != MAP_FAILED) {
+        *out_huge = VMEM_HUGE_EXPLICIT;
+        return addr;
+    }
+#    endif
+
+    // over-reserve so the range can be trimmed to a huge page boundary
+    uint64_t span = size + HUGE_PAGE_SIZE;
+    uint8_t *raw = vmem_reserve(span);
+    if (!raw) return NULL;
+
+    uintptr_t start = ((uintptr_t)raw + (HUGE_PAGE_SIZE - 1)) &
+                      ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+    uint64_t head = (uint64_t)(start - (uintptr_t)raw);
+    if (head) munmap(raw, head);
+    if (span - head > size) munmap((uint8_t *)start + size, span - head - size);
+
+    if (madvise((void *)start, size, MADV_HUGEPAGE) == 0) {
+        *out_huge = VMEM_HUGE_TRANSPARENT;
+    }
+    return (void *)start;
+}
+
+bool vmem_commit(void *addr, uint64_t size) {
+    if (mprotect(addr, size, PROT_READ | PROT_WRITE) != 0) {
+        LOG_ERROR("failed to commit %lu bytes at %p", size, addr);
+        return false;
+    }
+    return true;
+}
+
+void vmem_decommit(void *addr, uint64_t size) {
+    // drop the physical pages first so the range stays zero on recommit
+    madvise(addr, size, MADV_DONTNEED);
+    mprotect(addr, size, PROT_NONE);
+}
+
+void vmem_release(void *addr, uint64_t size) {
+    if (addr) munmap(addr, size);
+}
+
+void vmem_prefault(void *addr, uint64_t size) {
+    if (madvise(addr, size, MADV_POPULATE_WRITE) == 0) return;
+
+    // older kernels: write one byte per page, the pages are zero already
+    uint64_t page = vmem_page_size();
+    volatile uint8_t *bytes = addr;
+    for (uint64_t i = 0; i < size; i += page) {
+        bytes[i] = 0;
+    }
+}
+
+void vmem_fault_count(uint64_t *minor, uint64_t *major) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        *minor = *major = 0;
+        return;
+    }
+    *minor = (uint64_t)usage.ru_minflt;
+    *major = (uint64_t)usage.ru_majflt;
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef VMEM_H
+#define VMEM_H
+
+#include "core/define.h"
+
+typedef enum {
+    VMEM_HUGE_NONE = 0,
+    VMEM_HUGE_EXPLICIT,   // hugetlbfs pages (MAP_HUGETLB)
+    VMEM_HUGE_TRANSPARENT // regular mapping advised for THP
+} vmem_huge_t;
+
+// Thin wrapper over the OS virtual memory API. Reserved ranges have no
+// physical backing until committed, and committed pages read as zero.
+uint64_t vmem_page_size(void);
+uint64_t vmem_huge_page_size(void);
+
+void *vmem_reserve(uint64_t size);
+// `size` must be a multiple of vmem_huge_page_size(). Tries explicit huge
+// pages first, then a huge-page aligned range advised for THP, then plain.
+void *vmem_reserve_huge(uint64_t size, vmem_huge_t *out_huge);
+bool vmem_commit(void *addr, uint64_t size);
+void vmem_decommit(void *addr, uint64_t size);
+void vmem_release(void *addr, uint64_t size);
+
+// fault committed pages in now instead of on first touch
+void vmem_prefault(void *addr, uint64_t size);
+// page faults taken by the process so far
+void vmem_fault_count(uint64_t *minor, uint64_t *major);
+
+#endif // VMEM_H
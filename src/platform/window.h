@@ -11,6 +11,7 @@ typedef struct {
     const char *name;
 
     bool is_resizeable;
+    bool headless; // no display connection, nothing is shown
 } window_config_t;
 
 // TODO: this for Linux for now
@@ -20,6 +21,8 @@ typedef struct {
     void *display;
     uintptr_t win;
     uintptr_t atom;
+    int32_t xi_opcode; // XInput2, built with XI2_ENABLE
+    int32_t wake_fd;   // eventfd, window_system_wake() breaks a wait
 #elif PLATFORM_WINDOWS
 
 #endif
@@ -27,11 +30,22 @@ typedef struct {
     uint32_t width;
     uint32_t height;
     const char *name;
+    bool headless;
 } window_t;
 
+typedef struct {
+    uint32_t events; // X events handled by the last pump
+    uint32_t polls;  // poll() calls on the connection
+    uint32_t reads;  // polls that found data on the socket
+    uint32_t exposes; // the window needs to be drawn again
+    double time;     // seconds spent in the last pump
+    uint64_t events_total;
+} window_pump_stats_t;
+
 typedef struct {
     arena_alloc_t *arena;
     window_t native_win;
+    window_pump_stats_t stats;
 } window_system_t;
 
 // initializer state
@@ -41,6 +55,13 @@ void window_system_kill(window_system_t *window);
 
 bool window_system_pump(window_system_t *window, input_system_t *input,
                         event_system_t *event);
+// cost of the most recent pump
+window_pump_stats_t window_system_pump_stats(const window_system_t *window);
+// Block until the display has events or someone calls window_system_wake,
+// at most `timeout` seconds. Returns false when it timed out.
+bool window_system_wait(window_system_t *window, double timeout);
+// thread-safe
+void window_system_wake(window_system_t *window);
 
 void *window_system_get_native_display(const window_system_t *window);
 void *window_system_get_native_window(const window_system_t *window);
@@ -1,11 +1,18 @@
 #include "window.h"
+#include "core/latency.h"
 #if PLATFORM_LINUX
 #    include <time.h>
 #    include <string.h>
 #    include <unistd.h>
 
+#    include <poll.h>
+#    include <sys/eventfd.h>
+
 #    include <X11/XKBlib.h>
 #    include <X11/Xlib.h>
+#    if XI2_ENABLE
+#        include <X11/extensions/XInput2.h>
+#    endif
 
 window_system_t *window_system_init(window_config_t config,
                                     arena_alloc_t *arena) {
@@ -13,6 +20,23 @@ window_system_t *window_system_init(window_config_t config,
     if (!window) return NULL;
     memset(window, 0, sizeof(window_system_t));
 
+    window->native_win.width = config.width;
+    window->native_win.height = config.height;
+    window->native_win.name = config.name;
+
+    window->native_win.wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (window->native_win.wake_fd < 0) {
+        LOG_WARN("eventfd failed, idle waits only end on X events");
+    }
+
+    // the renderer draws offscreen, there is nothing to open
+    if (config.headless) {
+        window->native_win.headless = true;
+        LOG_INFO("window system initialized (headless %ux%u)", config.width,
+                 config.height);
+        return window;
+    }
+
     Display *dpy = XOpenDisplay(NULL);
     if (!dpy) {
         LOG_FATAL("failed to create window");
@@ -25,7 +49,7 @@ window_system_t *window_system_init(window_config_t config,
     attrs.background_pixel = BlackPixel(dpy, screen);
     attrs.event_mask = ExposureMask | KeyPressMask | KeyReleaseMask |
                        StructureNotifyMask | ButtonPressMask |
-                       ButtonReleaseMask;
+                       ButtonReleaseMask | PointerMotionMask;
 
     uint32_t value_mask = CWBackPixel | CWEventMask;
 
@@ -55,6 +79,25 @@ window_system_t *window_system_init(window_config_t config,
     window->native_win.win = win;
     window->native_win.atom = wm_delete;
 
+#    if XI2_ENABLE
+    // raw motion is only delivered to the root window
+    int32_t xi_event, xi_error, major = 2, minor = 0;
+    if (XQueryExtension(dpy, "XInputExtension", &window->native_win.xi_opcode,
+                        &xi_event, &xi_error) &&
+        XIQueryVersion(dpy, &major, &minor) == Success) {
+        unsigned char mask[XIMaskLen(XI_LASTEVENT)] = {0};
+        XIEventMask em = {.deviceid = XIAllMasterDevices,
+                          .mask_len = sizeof(mask),
+                          .mask = mask};
+        XISetMask(mask, XI_RawMotion);
+        XISelectEvents(dpy, DefaultRootWindow(dpy), &em, 1);
+        XFlush(dpy);
+        LOG_INFO("XInput2 %d.%d raw motion enabled", major, minor);
+    } else {
+        LOG_WARN("XInput2 unavailable, no raw mouse motion");
+    }
+#    endif
+
     LOG_INFO("window system initialized (X11)");
     return window;
 }
@@ -68,84 +111,219 @@ void window_system_kill(window_system_t *window) {
         XCloseDisplay(window->native_win.display);
         window->native_win.display = NULL;
     }
+    if (window->native_win.wake_fd >= 0) {
+        close(window->native_win.wake_fd);
+        window->native_win.wake_fd = -1;
+    }
     LOG_INFO("window system kill (X11)");
 }
 
-bool window_system_pump(window_system_t *window, input_system_t *input,
-                        event_system_t *event) {
-    XEvent ev;
-    bool is_quit = false;
+#    if XI2_ENABLE
+// unaccelerated device deltas, reported at the mouse's own rate
+static void translate_raw(window_system_t *window, input_system_t *input,
+                          event_system_t *event, XGenericEventCookie *cookie) {
+    Display *dpy = window->native_win.display;
+    if (!XGetEventData(dpy, cookie)) return;
 
-    while (XPending(window->native_win.display)) {
-        XNextEvent(window->native_win.display, &ev);
-
-        switch (ev.type) {
-            case KeyPress:
-            case KeyRelease: {
-                bool pressed = ev.type == KeyPress;
-                KeySym ks =
-                    XkbKeycodeToKeysym(window->native_win.display,
-                                       (KeyCode)ev.xkey.keycode, 0,
-                                       (ev.xkey.state & ShiftMask) ? 1 : 0);
-                input_keys_t key = keycode_translate((uint32_t)ks);
-                input_process_key(input, event, key, pressed);
-            } break;
-
-            case ButtonPress:
-            case ButtonRelease: {
-                bool pressed = ev.type == ButtonPress;
-                input_button_t mb = INPUT_MB_MAX;
-                switch (ev.xbutton.button) {
-                    case Button1: mb = INPUT_MB_LEFT; break;
-                    case Button2: mb = INPUT_MB_MIDDLE; break;
-                    case Button3: mb = INPUT_MB_RIGHT; break;
+    if (cookie->evtype == XI_RawMotion) {
+        XIRawEvent *raw = (XIRawEvent *)cookie->data;
+        const double *value = raw->raw_values;
+        double delta[2] = {0.0, 0.0};
+        for (int32_t i = 0; i < 2 && i < raw->valuators.mask_len * 8; ++i) {
+            if (XIMaskIsSet(raw->valuators.mask, i)) delta[i] = *value++;
+        }
+        latency_input();
+        input_process_mouse_raw(input, event, (int16_t)delta[0],
+                                (int16_t)delta[1]);
+    }
+    XFreeEventData(dpy, cookie);
+}
+#    endif
+
+// one X event into the input and event systems, false on window close
+static bool translate(window_system_t *window, input_system_t *input,
+                      event_system_t *event, XEvent *ev) {
+    Display *dpy = window->native_win.display;
+
+    switch (ev->type) {
+        case KeyPress:
+        case KeyRelease: {
+            latency_input();
+            bool pressed = ev->type == KeyPress;
+            KeySym ks = XkbKeycodeToKeysym(dpy, (KeyCode)ev->xkey.keycode, 0,
+                                           (ev->xkey.state & ShiftMask) ? 1
+                                                                        : 0);
+            input_keys_t key = keycode_translate((uint32_t)ks);
+
+            // X auto-repeat arrives as a release immediately followed
+            // by a press with the same keycode and timestamp
+            if (!pressed && XEventsQueued(dpy, QueuedAfterReading)) {
+                XEvent next;
+                XPeekEvent(dpy, &next);
+                if (next.type == KeyPress &&
+                    next.xkey.keycode == ev->xkey.keycode &&
+                    next.xkey.time == ev->xkey.time) {
+                    XNextEvent(dpy, &next);
+                    input_process_key_repeat(input, event, key);
+                    break;
                 }
-                if (mb != INPUT_MB_MAX)
-                    input_process_button(input, event, mb, pressed);
-            } break;
+            }
+            input_process_key(input, event, key, pressed);
+        } break;
+
+        case ButtonPress:
+        case ButtonRelease: {
+            latency_input();
+            bool pressed = ev->type == ButtonPress;
+            input_button_t mb = INPUT_MB_MAX;
+            switch (ev->xbutton.button) {
+                case Button1: mb = INPUT_MB_LEFT; break;
+                case Button2: mb = INPUT_MB_MIDDLE; break;
+                case Button3: mb = INPUT_MB_RIGHT; break;
+            }
+            if (mb != INPUT_MB_MAX)
+                input_process_button(input, event, mb, pressed);
+        } break;
+
+        case MotionNotify: {
+            latency_input();
+            input_process_mouse_move(input, event, (int16_t)ev->xmotion.x,
+                                     (int16_t)ev->xmotion.y);
+        } break;
+
+        case ConfigureNotify: {
+            XConfigureEvent *ce = (XConfigureEvent *)ev;
 
-            case MotionNotify: {
-                input_process_mouse_move(input, event, (int16_t)ev.xmotion.x,
-                                         (int16_t)ev.xmotion.y);
-            } break;
+            event_t e;
+            e.data.resize.width = (uint16_t)ce->width;
+            e.data.resize.height = (uint16_t)ce->height;
+            event_push(event, EVENT_RESIZE, &e, NULL);
+        } break;
 
-            case ConfigureNotify: {
-                XConfigureEvent *ce = (XConfigureEvent *)&ev;
+        case Expose: {
+            // the last of a batch of damaged rectangles
+            if (ev->xexpose.count == 0) window->stats.exposes++;
+        } break;
 
+        case UnmapNotify: {
+            event_t e = {};
+            event_push(event, EVENT_SUSPEND, &e, NULL);
+        } break;
+
+        case MapNotify: {
+            event_t e = {};
+            event_push(event, EVENT_RESUME, &e, NULL);
+        } break;
+
+        case ClientMessage: {
+            XClientMessageEvent *cm = (XClientMessageEvent *)ev;
+
+            if ((Atom)cm->data.l[0] == window->native_win.atom) {
                 event_t e;
-                e.data.resize.width = (uint16_t)ce->width;
-                e.data.resize.height = (uint16_t)ce->height;
-                event_push(event, EVENT_RESIZE, &e, NULL);
-            } break;
-
-            case UnmapNotify: {
-                event_t e = {};
-                event_push(event, EVENT_SUSPEND, &e, NULL);
-            } break;
-
-            case MapNotify: {
-                event_t e = {};
-                event_push(event, EVENT_RESUME, &e, NULL);
-            } break;
-
-            case ClientMessage: {
-                XClientMessageEvent *cm = (XClientMessageEvent *)&ev;
-
-                if ((Atom)cm->data.l[0] == window->native_win.atom) {
-                    event_t e;
-                    e.data.raw[0] = (uint8_t)cm->window;
-                    event_push(event, EVENT_QUIT, &e, NULL);
-                    is_quit = true;
-                }
-            } break;
+                e.data.raw[0] = (uint8_t)cm->window;
+                event_push(event, EVENT_QUIT, &e, NULL);
+                return false;
+            }
+        } break;
+
+#    if XI2_ENABLE
+        case GenericEvent: {
+            if (ev->xcookie.extension == window->native_win.xi_opcode) {
+                translate_raw(window, input, event, &ev->xcookie);
+            }
+        } break;
+#    endif
+
+        default: break;
+    }
+    return true;
+}
+
+// XPending flushes and may round-trip on every call. Instead, drain what
+// Xlib already buffered, and only touch the socket when poll() says there
+// is something to read, so an idle frame costs a single poll syscall.
+bool window_system_pump(window_system_t *window, input_system_t *input,
+                        event_system_t *event) {
+    window_pump_stats_t *stats = &window->stats;
+    stats->events = 0;
+    stats->polls = 0;
+    stats->reads = 0;
+    stats->exposes = 0;
+    if (window->native_win.headless) return true;
+
+    double start = get_abs_time();
+    Display *dpy = window->native_win.display;
+    struct pollfd pfd = {.fd = ConnectionNumber(dpy), .events = POLLIN};
+    bool is_quit = false;
+
+    for (;;) {
+        if (XEventsQueued(dpy, QueuedAlready) == 0) {
+            stats->polls++;
+            if (poll(&pfd, 1, 0) <= 0) break;
+
+            stats->reads++;
+            if (XEventsQueued(dpy, QueuedAfterReading) == 0) break;
+        }
 
-            default: break;
+        // re-checked every time: translate may take an auto-repeat press
+        // off the queue, a stale count would block in XNextEvent
+        while (XEventsQueued(dpy, QueuedAlready) > 0) {
+            XEvent ev;
+            XNextEvent(dpy, &ev);
+            stats->events++;
+            if (!translate(window, input, event, &ev)) is_quit = true;
         }
-        return !is_quit;
+    }
+
+    // requests made since the last pump (none per frame, normally)
+    XFlush(dpy);
+
+    stats->time = get_abs_time() - start;
+    stats->events_total += stats->events;
+    return !is_quit;
+}
+
+window_pump_stats_t window_system_pump_stats(const window_system_t *window) {
+    return window->stats;
+}
+
+bool window_system_wait(window_system_t *window, double timeout) {
+    Display *dpy = window->native_win.display;
+    struct pollfd pfd[2];
+    nfds_t count = 0;
+
+    if (dpy) {
+        if (XEventsQueued(dpy, QueuedAlready) > 0) return true;
+        // nothing we asked for may still sit in the output buffer
+        XFlush(dpy);
+        pfd[count++] =
+            (struct pollfd){.fd = ConnectionNumber(dpy), .events = POLLIN};
+    }
+    int32_t wake = window->native_win.wake_fd;
+    if (wake >= 0) pfd[count++] = (struct pollfd){.fd = wake, .events = POLLIN};
+
+    if (count == 0) {
+        get_sleep(get_abs_time() + timeout);
+        return false;
+    }
+    if (poll(pfd, count, (int32_t)(timeout * 1000.0)) <= 0) return false;
+
+    // reset the counter, any number of wakes is one trip round the loop
+    if (wake >= 0 && (pfd[count - 1].revents & POLLIN)) {
+        uint64_t n;
+        ssize_t got = read(wake, &n, sizeof(n));
+        (void)got;
     }
     return true;
 }
 
+void window_system_wake(window_system_t *window) {
+    if (window->native_win.wake_fd < 0) return;
+    uint64_t one = 1;
+    ssize_t put = write(window->native_win.wake_fd, &one, sizeof(one));
+    (void)put;
+}
+
 void *window_system_get_native_display(const window_system_t *window) {
     return window->native_win.display; // Returns Display* for X11
 }
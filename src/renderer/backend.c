@@ -19,6 +19,9 @@ static const char *const req_device_ext[] = {
     VK_KHR_SWAPCHAIN_EXTENSION_NAME,
 };
 
+// the first SURFACE_EXT_COUNT entries are left out when headless
+#define SURFACE_EXT_COUNT 2
+
 static const char *const req_instance_ext[] = {
     VK_KHR_SURFACE_EXTENSION_NAME,
 #if defined(PLATFORM_LINUX)
@@ -135,7 +138,10 @@ void get_req_ext(const char *const **out_list, uint32_t *ext_count) {
     if (ext_count) *ext_count = ARRAY_SIZE(req_instance_ext);
 }
 
-static bool chk_dvc_support(VkPhysicalDevice gpu) {
+static bool chk_dvc_support(vk_core_t *core, VkPhysicalDevice gpu) {
+    // offscreen rendering needs nothing beyond core Vulkan
+    if (core->headless) return true;
+
     uint32_t count = 0;
 
     re.vkEnumerateDeviceExtensionProperties(gpu, NULL, &count, NULL);
@@ -200,7 +206,7 @@ static bool pick_physical_device(vk_core_t *core) {
     int32_t best_score = -1;
 
     for (uint32_t i = 0; i < count; ++i) {
-        if (!chk_dvc_support(gpus[i])) continue;
+        if (!chk_dvc_support(core, gpus[i])) continue;
 
         int32_t score = score_device(gpus[i]);
         if (score > best_score) {
@@ -263,6 +269,9 @@ static bool pick_queue_families(vk_core_t *core) {
     if (core->transfer_idx == UINT32_MAX)
         core->transfer_idx = core->graphic_idx;
 
+    // there is no surface to query, "present" happens on the graphics queue
+    if (core->headless) core->present_idx = core->graphic_idx;
+
     WFREE(families, sizeof(VkQueueFamilyProperties) * count, MEM_RENDER);
     return (core->graphic_idx != UINT32_MAX);
 }
@@ -294,7 +303,8 @@ static bool create_logical_device(vk_core_t *core) {
     info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     info.queueCreateInfoCount = unique_count;
     info.pQueueCreateInfos = queues;
-    info.enabledExtensionCount = ARRAY_SIZE(req_device_ext);
+    info.enabledExtensionCount =
+        core->headless ? 0 : (uint32_t)ARRAY_SIZE(req_device_ext);
     info.ppEnabledExtensionNames = req_device_ext;
     info.pEnabledFeatures = &enable_feats;
 
@@ -322,6 +332,12 @@ static bool create_command_pool(vk_core_t *core) {
     CHECK_VK(re.vkCreateCommandPool(core->logic_dvc, &pool, core->alloc,
                                     &core->gfx_pool));
 
+    // one-shot upload buffers, kept apart so uploads from other threads
+    // never touch the pool the frame command buffers live in
+    pool.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    CHECK_VK(re.vkCreateCommandPool(core->logic_dvc, &pool, core->alloc,
+                                    &core->upload_pool));
+
     LOG_DEBUG("vulkan command pool initialize");
     return true;
 }
@@ -343,6 +359,10 @@ static bool init_instance(vk_core_t *core) {
     const char *const *inst_exts;
     uint32_t inst_ext_count;
     get_req_ext(&inst_exts, &inst_ext_count);
+    if (core->headless) {
+        inst_exts += SURFACE_EXT_COUNT;
+        inst_ext_count -= SURFACE_EXT_COUNT;
+    }
 
     uint32_t layer_count = 0;
     const char *const *layer_names = NULL;
@@ -415,6 +435,8 @@ bool core_init(vk_core_t *core) {
 }
 
 void core_kill(vk_core_t *core) {
+    re.vkDestroyCommandPool(core->logic_dvc, core->upload_pool, core->alloc);
+    core->upload_pool = VK_NULL_HANDLE;
     re.vkDestroyCommandPool(core->logic_dvc, core->gfx_pool, core->alloc);
     core->gfx_pool = VK_NULL_HANDLE;
     LOG_DEBUG("vulkan command pool kill");
@@ -432,9 +454,10 @@ void core_kill(vk_core_t *core) {
     LOG_DEBUG("vulkan core kill");
 }
 
-bool re_memalloc(vk_core_t *core, VkMemoryRequirements *memory_req,
-                 VkMemoryPropertyFlags flags, VkDeviceMemory *out,
-                 vram_tag_t tag) {
+bool re_memalloc_dbg(vk_core_t *core, VkMemoryRequirements *memory_req,
+                     VkMemoryPropertyFlags flags, VkDeviceMemory *out,
+                     vram_tag_t tag, const char *file, uint32_t line) {
+    memory_frame_record("vkAllocateMemory", memory_req->size, file, line);
 
     if ((core->memories.total_allocated + memory_req->size) >
         core->memories.budget) {
@@ -568,7 +591,11 @@ static bool query_surface_details(vk_swapchain_t *swp, vk_core_t *core) {
         WALLOC(sizeof(VkPresentModeKHR) * mode_count, MEM_RENDER);
     re.vkGetPhysicalDeviceSurfacePresentModesKHR(core->gpu, swp->surface,
                                                  &mode_count, modes);
-    swp->present_mode = modes[0];
+    swp->mode_mask = 0;
+    for (uint32_t i = 0; i < mode_count; ++i) {
+        // extension modes have huge enum values, none of them are used
+        if ((uint32_t)modes[i] < 32) swp->mode_mask |= 1u << modes[i];
+    }
     WFREE(modes, sizeof(VkPresentModeKHR) * mode_count, MEM_RENDER);
 
     return true;
@@ -582,16 +609,26 @@ static void choose_surface_format(vk_swapchain_t *swp) {
     }
 }
 
-static void choose_present_mode(vk_swapchain_t *swp) {
-    // prefer MAILBOX > FIFO
-    /*
-    if (swp->present_mode != VK_PRESENT_MODE_MAILBOX_KHR) {
-        swp->present_mode = VK_PRESENT_MODE_FIFO_KHR;
+static const char *present_mode_str(VkPresentModeKHR mode) {
+    switch (mode) {
+        case VK_PRESENT_MODE_IMMEDIATE_KHR: return "IMMEDIATE";
+        case VK_PRESENT_MODE_MAILBOX_KHR: return "MAILBOX";
+        case VK_PRESENT_MODE_FIFO_KHR: return "FIFO";
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "FIFO_RELAXED";
+        default: return "UNKNOWN";
     }
-    */
+}
 
-    // prefer FIFO > MAILBOX
+static void choose_present_mode(vk_swapchain_t *swp) {
+    // FIFO is the one mode every surface has to support
     swp->present_mode = VK_PRESENT_MODE_FIFO_KHR;
+    if ((uint32_t)swp->want_mode < 32 &&
+        (swp->mode_mask & (1u << swp->want_mode))) {
+        swp->present_mode = swp->want_mode;
+    } else {
+        LOG_WARN("present mode %s not supported, using FIFO",
+                 present_mode_str(swp->want_mode));
+    }
 }
 
 static void choose_swap_extent(vk_swapchain_t *swp, window_t *window) {
@@ -609,11 +646,19 @@ static void choose_swap_extent(vk_swapchain_t *swp, window_t *window) {
 
 static bool create_swapchain(vk_swapchain_t *swp, vk_core_t *core,
                              VkSwapchainKHR old_handle) {
+    // one more than the minimum, so acquire doesn't wait on the
+    // presentation engine to let go of an image
     uint32_t image_count = swp->caps.minImageCount + 1;
+    if (swp->want_images) image_count = swp->want_images;
+    if (image_count < swp->caps.minImageCount) {
+        image_count = swp->caps.minImageCount;
+    }
     if (swp->caps.maxImageCount > 0 && image_count > swp->caps.maxImageCount) {
         image_count = swp->caps.maxImageCount;
     }
-    LOG_TRACE("image count from swapchain: %d", image_count);
+    LOG_INFO("swapchain %s, %u images (surface allows %u..%u)",
+             present_mode_str(swp->present_mode), image_count,
+             swp->caps.minImageCount, swp->caps.maxImageCount);
 
     VkSwapchainCreateInfoKHR info = {};
     info.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
@@ -708,26 +753,17 @@ static bool create_image_view(vk_image_t *out, vk_core_t *core, VkFormat format,
 }
 
 static void destroy_image_views(vk_swapchain_t *swp, vk_core_t *core) {
+    if (!swp->img_views) return;
     for (uint32_t i = 0; i < swp->image_count; ++i) {
         re.vkDestroyImageView(core->logic_dvc, swp->img_views[i], core->alloc);
     }
     WFREE(swp->img_views, sizeof(VkImageView) * swp->image_count, MEM_RENDER);
     WFREE(swp->images, sizeof(VkImage) * swp->image_count, MEM_RENDER);
+    swp->img_views = NULL;
+    swp->images = NULL;
 }
 
-bool swapchain_init(vk_swapchain_t *swp, vk_core_t *core, window_t *window,
-                    VkSwapchainKHR old_handle) {
-    if (!create_surface(swp, core, window)) return false;
-    if (!pick_present_queue(core, swp->surface)) return false;
-    if (!query_surface_details(swp, core)) return false;
-    choose_surface_format(swp);
-    choose_present_mode(swp);
-    choose_swap_extent(swp, window);
-    if (!create_swapchain(swp, core, old_handle)) return false;
-
-    // image swapchain
-    if (!create_sw_image_views(swp, core)) return false;
-
+static bool create_attachments(vk_swapchain_t *swp, vk_core_t *core) {
     // color attachment
     if (!image_init(&swp->color_attach, core, swp->image_format,
                     VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
@@ -746,6 +782,72 @@ bool swapchain_init(vk_swapchain_t *swp, vk_core_t *core, window_t *window,
         LOG_ERROR("failed to create depth attachment swapchain");
         return false;
     }
+    return true;
+}
+
+// Headless stand-in for the swapchain: a ring of plain color images the
+// main pass renders into. They are never shown, so one format works on any
+// device, software rasterizers included.
+static bool create_offscreen_images(vk_swapchain_t *swp, vk_core_t *core,
+                                    window_t *window) {
+    swp->image_count = OFFSCREEN_IMAGE_COUNT;
+    swp->image_format = VK_FORMAT_B8G8R8A8_UNORM;
+    swp->surface_format.format = swp->image_format;
+    swp->surface_format.colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+    swp->extents.width = window->width;
+    swp->extents.height = window->height;
+
+    swp->offscreen = WALLOC(sizeof(vk_image_t) * swp->image_count, MEM_RENDER);
+    swp->images = WALLOC(sizeof(VkImage) * swp->image_count, MEM_RENDER);
+    swp->img_views = WALLOC(sizeof(VkImageView) * swp->image_count, MEM_RENDER);
+    for (uint32_t i = 0; i < swp->image_count; ++i) {
+        if (!image_init(&swp->offscreen[i], core, swp->image_format,
+                        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                            VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                        VK_IMAGE_ASPECT_COLOR_BIT, swp->extents.width,
+                        swp->extents.height, true, RE_RENDER_TARGET)) {
+            LOG_ERROR("failed to create offscreen image %u", i);
+            return false;
+        }
+        swp->images[i] = swp->offscreen[i].handle;
+        swp->img_views[i] = swp->offscreen[i].view;
+    }
+
+    LOG_DEBUG("vulkan offscreen ring initialize: %u images %ux%u",
+              swp->image_count, swp->extents.width, swp->extents.height);
+    return true;
+}
+
+static void destroy_offscreen_images(vk_swapchain_t *swp, vk_core_t *core) {
+    for (uint32_t i = 0; i < swp->image_count; ++i) {
+        image_kill(&swp->offscreen[i], core, RE_RENDER_TARGET);
+    }
+    WFREE(swp->offscreen, sizeof(vk_image_t) * swp->image_count, MEM_RENDER);
+    WFREE(swp->img_views, sizeof(VkImageView) * swp->image_count, MEM_RENDER);
+    WFREE(swp->images, sizeof(VkImage) * swp->image_count, MEM_RENDER);
+    swp->offscreen = NULL;
+}
+
+bool swapchain_init(vk_swapchain_t *swp, vk_core_t *core, window_t *window,
+                    VkSwapchainKHR old_handle) {
+    if (core->headless) {
+        if (!create_offscreen_images(swp, core, window)) return false;
+        swp->present_layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        return create_attachments(swp, core);
+    }
+
+    if (!create_surface(swp, core, window)) return false;
+    if (!pick_present_queue(core, swp->surface)) return false;
+    if (!query_surface_details(swp, core)) return false;
+    choose_surface_format(swp);
+    choose_present_mode(swp);
+    choose_swap_extent(swp, window);
+    if (!create_swapchain(swp, core, old_handle)) return false;
+
+    // image swapchain
+    if (!create_sw_image_views(swp, core)) return false;
+    swp->present_layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    if (!create_attachments(swp, core)) return false;
 
     if (old_handle && old_handle != VK_NULL_HANDLE) {
         LOG_DEBUG("vulkan swapchain initialize with old handle: %p",
@@ -757,17 +859,25 @@ bool swapchain_init(vk_swapchain_t *swp, vk_core_t *core, window_t *window,
     return true;
 }
 
-void swapchain_kill(vk_swapchain_t *swp, vk_core_t *core) {
+void swapchain_release(vk_swapchain_t *swp, vk_core_t *core) {
     image_kill(&swp->depth_attach, core, RE_DEPTH_TARGET);
     image_kill(&swp->color_attach, core, RE_RENDER_TARGET);
 
-    destroy_image_views(swp, core);
+    if (swp->offscreen) {
+        destroy_offscreen_images(swp, core);
+    } else {
+        destroy_image_views(swp, core);
+    }
 
     if (swp->handle != VK_NULL_HANDLE) {
         re.vkDestroySwapchainKHR(core->logic_dvc, swp->handle, core->alloc);
         swp->handle = VK_NULL_HANDLE;
         LOG_DEBUG("vulkan swapchain kill");
     }
+}
+
+void swapchain_kill(vk_swapchain_t *swp, vk_core_t *core) {
+    swapchain_release(swp, core);
 
     if (swp->surface != VK_NULL_HANDLE) {
         re.vkDestroySurfaceKHR(core->instance, swp->surface, core->alloc);
@@ -776,22 +886,23 @@ void swapchain_kill(vk_swapchain_t *swp, vk_core_t *core) {
     }
 }
 
-bool swapchain_reinit(vk_swapchain_t *swp, vk_core_t *core, window_t *window) {
-    VkSwapchainKHR old_swapchain = swp->handle;
+bool swapchain_reinit(vk_swapchain_t *swp, vk_core_t *core, window_t *window,
+                      vk_swapchain_t *retired) {
+    memset(retired, 0, sizeof(vk_swapchain_t));
+    // the offscreen ring never goes out of date
+    if (swp->offscreen) return true;
 
-    if (old_swapchain != VK_NULL_HANDLE) {
-        image_kill(&swp->depth_attach, core, RE_DEPTH_TARGET);
-        image_kill(&swp->color_attach, core, RE_RENDER_TARGET);
-        destroy_image_views(swp, core);
-    }
+    // the retired copy owns the old handle, images and attachments now
+    *retired = *swp;
+    retired->framebuffer = NULL;
+    swp->images = NULL;
+    swp->img_views = NULL;
+    swp->handle = VK_NULL_HANDLE;
+    memset(&swp->color_attach, 0, sizeof(vk_image_t));
+    memset(&swp->depth_attach, 0, sizeof(vk_image_t));
 
-    if (!swapchain_init(swp, core, window, old_swapchain)) return false;
-
-    if (old_swapchain != VK_NULL_HANDLE) {
-        re.vkDestroySwapchainKHR(core->logic_dvc, old_swapchain, core->alloc);
-    }
-
-    return true;
+    // the surface stays, only its size and the images change
+    return swapchain_init(swp, core, window, retired->handle);
 }
 
 bool image_init(vk_image_t *out, vk_core_t *core, VkFormat format,
@@ -950,7 +1061,7 @@ bool renderpass_init(vk_core_t *core, vk_renderpass_t *rpass,
     color.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     color.initialLayout = prev_pass ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
                                     : VK_IMAGE_LAYOUT_UNDEFINED;
-    color.finalLayout = next_pass ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+    color.finalLayout = next_pass ? swap->present_layout
                                   : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
     attachments[attach_count++] = color;
 
@@ -1437,43 +1548,47 @@ static void unset_shader(vk_core_t *core, vk_material_t *material) {
 
 static bool set_material_descriptors(vk_core_t *core, vk_material_t *mat) {
     // Allocate global descriptor
-    void *glob_map = NULL;
-    VkResult res = re.vkMapMemory(core->logic_dvc, mat->buffers.memory, 0,
-                                  sizeof(vk_camera_data_t), 0, &glob_map);
+    VkResult res;
+    for (uint32_t i = 0; i < FRAME_FLIGHT; ++i) {
+        void *glob_map = NULL;
+        res = re.vkMapMemory(core->logic_dvc, mat->buffers[i].memory, 0,
+                             sizeof(vk_camera_data_t), 0, &glob_map);
 
-    if (res == VK_SUCCESS) {
-        mat->buffers.mapped = glob_map;
-    } else {
-        mat->buffers.mapped = NULL;
-        LOG_ERROR("Failed to map UBO buffer");
-    }
+        if (res == VK_SUCCESS) {
+            mat->buffers[i].mapped = glob_map;
+        } else {
+            mat->buffers[i].mapped = NULL;
+            LOG_ERROR("Failed to map UBO buffer");
+        }
 
-    VkDescriptorSetAllocateInfo glob_alloc = {
-        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-        .descriptorPool = mat->global_pool,
-        .descriptorSetCount = 1,
-        .pSetLayouts = &mat->global_layout,
-    };
+        VkDescriptorSetAllocateInfo glob_alloc = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .descriptorPool = mat->global_pool,
+            .descriptorSetCount = 1,
+            .pSetLayouts = &mat->global_layout,
+        };
 
-    if (re.vkAllocateDescriptorSets(core->logic_dvc, &glob_alloc,
-                                    &mat->global_sets) != VK_SUCCESS) {
-        LOG_ERROR("Failed to allocate global descriptor set");
-        return false;
-    }
+        if (re.vkAllocateDescriptorSets(core->logic_dvc, &glob_alloc,
+                                        &mat->global_sets[i]) != VK_SUCCESS) {
+            LOG_ERROR("Failed to allocate global descriptor set");
+            return false;
+        }
 
-    VkDescriptorBufferInfo glob_buffer = {.buffer = mat->buffers.handle,
-                                          .offset = 0,
-                                          .range = sizeof(vk_camera_data_t)};
+        VkDescriptorBufferInfo glob_buffer = {.buffer = mat->buffers[i].handle,
+                                              .offset = 0,
+                                              .range =
+                                                  sizeof(vk_camera_data_t)};
 
-    VkWriteDescriptorSet glob_write = {
-        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-        .dstSet = mat->global_sets,
-        .dstBinding = 0,
-        .descriptorCount = 1,
-        .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-        .pBufferInfo = &glob_buffer,
-    };
-    re.vkUpdateDescriptorSets(core->logic_dvc, 1, &glob_write, 0, NULL);
+        VkWriteDescriptorSet glob_write = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = mat->global_sets[i],
+            .dstBinding = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            .pBufferInfo = &glob_buffer,
+        };
+        re.vkUpdateDescriptorSets(core->logic_dvc, 1, &glob_write, 0, NULL);
+    }
 
     // Allocate object descriptor
     for (uint32_t i = 0; i < FRAME_FLIGHT; ++i) {
@@ -1651,16 +1766,16 @@ bool material_world_init(vk_core_t *core, vk_renderpass_t *rpass,
     CHECK_VK(re.vkCreateDescriptorPool(core->logic_dvc, &obj_pool, core->alloc,
                                        &mat->object_pool));
 
-    if (!buffer_init(core, &mat->buffers, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                     sizeof(vk_camera_data_t),
-                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                         VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                     RE_BUFFER_UNIFORM)) {
-        LOG_ERROR("Failed to create global buffer");
-        return false;
-    }
-
     for (uint32_t i = 0; i < FRAME_FLIGHT; ++i) {
+        if (!buffer_init(core, &mat->buffers[i],
+                         VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                         sizeof(vk_camera_data_t),
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         RE_BUFFER_UNIFORM)) {
+            LOG_ERROR("Failed to create global buffer");
+            return false;
+        }
         if (!buffer_init(core, &mat->obj_buffers[i],
                          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
                          sizeof(vk_object_data_t),
@@ -1684,8 +1799,8 @@ void material_kill(vk_core_t *core, vk_material_t *material) {
     VkMemoryPropertyFlags mem_prop = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
                                      VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
-    buffer_kill(core, &material->buffers, mem_prop, RE_BUFFER_UNIFORM);
     for (uint32_t i = 0; i < FRAME_FLIGHT; ++i) {
+        buffer_kill(core, &material->buffers[i], mem_prop, RE_BUFFER_UNIFORM);
         buffer_kill(core, &material->obj_buffers[i], mem_prop,
                     RE_BUFFER_UNIFORM);
     }
@@ -1751,7 +1866,7 @@ void material_bind(vk_core_t *core, vk_material_t *mat, VkCommandBuffer buffer,
     };
 
     VkDescriptorSet sets[2] = {
-        mat->global_sets,
+        mat->global_sets[frame_idx],
         mat->object_set[frame_idx],
     };
 
@@ -7,9 +7,13 @@
 bool core_init(vk_core_t *core);
 void core_kill(vk_core_t *core);
 
-bool re_memalloc(vk_core_t *core, VkMemoryRequirements *memory_req,
-                 VkMemoryPropertyFlags flags, VkDeviceMemory *out,
-                 vram_tag_t tag);
+// call site is passed along so per-frame allocation checks can report it
+#define re_memalloc(core, memory_req, flags, out, tag)                         \
+    re_memalloc_dbg(core, memory_req, flags, out, tag, __FILE__, __LINE__)
+
+bool re_memalloc_dbg(vk_core_t *core, VkMemoryRequirements *memory_req,
+                     VkMemoryPropertyFlags flags, VkDeviceMemory *out,
+                     vram_tag_t tag, const char *file, uint32_t line);
 
 void re_memfree(vk_core_t *core, VkDeviceMemory memory,
                 VkMemoryPropertyFlags flags, VkDeviceSize size, vram_tag_t tag);
@@ -22,7 +26,14 @@ bool swapchain_init(vk_swapchain_t *swp, vk_core_t *core, window_t *window,
 
 void swapchain_kill(vk_swapchain_t *swp, vk_core_t *core);
 
-bool swapchain_reinit(vk_swapchain_t *swp, vk_core_t *core, window_t *window);
+// New swapchain for the surface's current size, the old handle is passed as
+// oldSwapchain. The old handle, image views and attachments move to
+// `retired`, still alive: the GPU may be using them. Free them with
+// swapchain_release once the frames that did have retired.
+bool swapchain_reinit(vk_swapchain_t *swp, vk_core_t *core, window_t *window,
+                      vk_swapchain_t *retired);
+// everything but the surface
+void swapchain_release(vk_swapchain_t *swp, vk_core_t *core);
 
 bool image_init(vk_image_t *out, vk_core_t *core, VkFormat format,
                 VkImageUsageFlags usage, VkImageAspectFlags flags,
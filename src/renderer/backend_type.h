@@ -7,6 +7,7 @@
 #include "frontend_type.h"
 
 #define FRAME_FLIGHT 2
+#define OFFSCREEN_IMAGE_COUNT 3 // headless ring, stands in for the swapchain
 
 #define VK_MATERIAL_COUNT 1024
 #define VK_SHADER_SAMPLER_COUNT 1
@@ -43,6 +44,15 @@ typedef struct vk_swapchain_t {
     VkFormat image_format;
     uint32_t image_count;
 
+    // asked for at init, kept across recreation
+    VkPresentModeKHR want_mode;
+    uint32_t want_images; // 0 = minImageCount + 1
+    uint32_t mode_mask;   // bit per core VkPresentModeKHR the surface has
+
+    // headless: `images`/`img_views` alias this ring, no surface or handle
+    vk_image_t *offscreen;
+    VkImageLayout present_layout; // layout the main pass leaves images in
+
     vk_image_t color_attach;
     vk_image_t depth_attach;
 } vk_swapchain_t;
@@ -123,11 +133,13 @@ typedef struct {
 
     vk_camera_data_t cam_ubo_data;
 
-    vk_buffer_t buffers;
+    // camera UBO, one slot per frame in flight so a write never races the
+    // GPU reading the previous frame
+    vk_buffer_t buffers[FRAME_FLIGHT];
     vk_shader_t shaders;
     vk_pipeline_t pipelines;
 
-    VkDescriptorSet global_sets;
+    VkDescriptorSet global_sets[FRAME_FLIGHT];
     VkDescriptorPool global_pool;
     VkDescriptorSetLayout global_layout;
 
@@ -181,6 +193,7 @@ typedef struct {
     VkPhysicalDevice gpu;
     VkDevice logic_dvc;
     VkCommandPool gfx_pool;
+    VkCommandPool upload_pool; // frontend's upload lock guards it
 
     VkPhysicalDeviceProperties properties;
     VkPhysicalDeviceFeatures features;
@@ -204,6 +217,8 @@ typedef struct {
     uint32_t graphic_idx;
     uint32_t present_idx;
     uint32_t transfer_idx;
+
+    bool headless; // no surface or swapchain extensions
 } vk_core_t;
 
 #endif // RENDERER_TYPE_H
@@ -1,13 +1,20 @@
 #include "frontend.h"
 #include "backend.h"
 #include "core/memory.h"
+#include "core/latency.h"
 #include "core/math/maths.h"
+#include "platform/thread.h"
 
 #include <string.h>
 #include <stdio.h>
 
 static render_system_t *g_re = NULL;
 
+// Uploads may come from loader threads. This serializes them with each
+// other and with the frame's submit/present: graphic_queue, upload_pool and
+// texture_pool all need external synchronization.
+static mutex_t g_upload_lock;
+
 static const char *tag_str[RE_COUNT] = {
     "RE_UNKNOWN",
     "RE_TEXTURE",        // Base color, normal, roughness/metallic maps
@@ -71,6 +78,31 @@ char *vram_status(render_system_t *r) {
 /************************************
  * SYNCRONIZATION
  ************************************/
+// one per swapchain image, rebuilt along with the swapchain
+static void set_image_sync(render_system_t *r) {
+    uint32_t count = r->vk.swap.image_count;
+    r->vk.image_fence = WALLOC(sizeof(VkFence) * count, MEM_RENDER);
+    for (uint32_t i = 0; i < count; ++i) {
+        r->vk.image_fence[i] = VK_NULL_HANDLE;
+    }
+
+    r->vk.done_sema = WALLOC(sizeof(VkSemaphore) * count, MEM_RENDER);
+    for (uint32_t i = 0; i < count; ++i) {
+        VkSemaphoreCreateInfo sm_info = {};
+        sm_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        re.vkCreateSemaphore(r->vk.core.logic_dvc, &sm_info, r->vk.core.alloc,
+                             &r->vk.done_sema[i]);
+    }
+}
+
+static void free_semaphores(render_system_t *r, VkSemaphore *sema,
+                            uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) {
+        re.vkDestroySemaphore(r->vk.core.logic_dvc, sema[i], r->vk.core.alloc);
+    }
+    WFREE(sema, sizeof(VkSemaphore) * count, MEM_RENDER);
+}
+
 static bool set_sync(render_system_t *r) {
     VkDevice dev = r->vk.core.logic_dvc;
 
@@ -91,31 +123,14 @@ static bool set_sync(render_system_t *r) {
     }
 
     // allocation for image count from swapchain
-    uint32_t count = r->vk.swap.image_count;
-    r->vk.image_fence = WALLOC(sizeof(VkSemaphore) * count, MEM_RENDER);
-    for (uint32_t i = 0; i < count; ++i) {
-        r->vk.image_fence[i] = VK_NULL_HANDLE;
-    }
-
-    r->vk.done_sema = WALLOC(sizeof(VkSemaphore) * count, MEM_RENDER);
-    for (uint32_t i = 0; i < count; ++i) {
-        VkSemaphoreCreateInfo sm_info = {};
-        sm_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-        re.vkCreateSemaphore(r->vk.core.logic_dvc, &sm_info, r->vk.core.alloc,
-                             &r->vk.done_sema[i]);
-    }
-
+    set_image_sync(r);
     return true;
 }
 
 static void unset_sync(render_system_t *r) {
     uint32_t count = r->vk.swap.image_count;
-    for (uint32_t i = 0; i < count; ++i) {
-        re.vkDestroySemaphore(r->vk.core.logic_dvc, r->vk.done_sema[i],
-                              r->vk.core.alloc);
-    }
-    WFREE(r->vk.done_sema, sizeof(VkSemaphore) * count, MEM_RENDER);
-    WFREE(r->vk.image_fence, sizeof(VkSemaphore) * count, MEM_RENDER);
+    free_semaphores(r, r->vk.done_sema, count);
+    WFREE(r->vk.image_fence, sizeof(VkFence) * count, MEM_RENDER);
 
     for (uint16_t i = 0; i < FRAME_FLIGHT; ++i) {
         if (r->vk.avail_sema[i]) {
@@ -189,30 +204,28 @@ static void start_framebuffer(render_system_t *r) {
     }
 }
 
-static void stop_framebuffer(render_system_t *r) {
-    for (uint32_t i = 0; i < r->vk.swap.image_count; ++i) {
-        re.vkDestroyFramebuffer(r->vk.core.logic_dvc, r->vk.main_framebuff[i],
-                                r->vk.core.alloc);
-
-        re.vkDestroyFramebuffer(r->vk.core.logic_dvc, r->vk.swap.framebuffer[i],
-                                r->vk.core.alloc);
+static void free_framebuffer(render_system_t *r, VkFramebuffer *fb,
+                             uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) {
+        re.vkDestroyFramebuffer(r->vk.core.logic_dvc, fb[i], r->vk.core.alloc);
     }
+    WFREE(fb, sizeof(VkFramebuffer) * count, MEM_RENDER);
 }
 
 static bool set_framebuffer(render_system_t *r) {
     uint32_t count = r->vk.swap.image_count;
     r->vk.main_framebuff = WALLOC(sizeof(VkFramebuffer) * count, MEM_RENDER);
     r->vk.swap.framebuffer = WALLOC(sizeof(VkFramebuffer) * count, MEM_RENDER);
+    // overlay pass is not there yet, keep its slots null so kill is a no-op
+    memset(r->vk.swap.framebuffer, 0, sizeof(VkFramebuffer) * count);
     start_framebuffer(r);
     return true;
 }
 
 static void unset_framebuffer(render_system_t *r) {
-    stop_framebuffer(r);
-    WFREE(r->vk.swap.framebuffer,
-          sizeof(VkFramebuffer) * r->vk.swap.image_count, MEM_RENDER);
-    WFREE(r->vk.main_framebuff, sizeof(VkFramebuffer) * r->vk.swap.image_count,
-          MEM_RENDER);
+    uint32_t count = r->vk.swap.image_count;
+    free_framebuffer(r, r->vk.swap.framebuffer, count);
+    free_framebuffer(r, r->vk.main_framebuff, count);
 }
 
 /************************************
@@ -323,6 +336,78 @@ if (mat->data.has_texture) {
 }
 */
 
+/************************************
+ * SWAPCHAIN RECREATE
+ ************************************/
+static void wait_slot(render_system_t *r, uint32_t slot) {
+    re.vkWaitForFences(r->vk.core.logic_dvc, 1, &r->vk.frame_fence[slot],
+                       VK_TRUE, UINT64_MAX);
+    r->vk.done_serial = MAX(r->vk.done_serial, r->vk.slot_serial[slot]);
+}
+
+// `all` skips the serial check, the caller made sure the GPU is done
+static void release_retired(render_system_t *r, bool all) {
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < r->vk.retired_count; ++i) {
+        render_retired_t *old = &r->vk.retired[i];
+        if (!all && old->free_after > r->vk.done_serial) {
+            r->vk.retired[kept++] = *old;
+            continue;
+        }
+        uint32_t count = old->swap.image_count;
+        free_framebuffer(r, old->main_framebuff, count);
+        free_framebuffer(r, old->ui_framebuff, count);
+        free_semaphores(r, old->done_sema, count);
+        swapchain_release(&old->swap, &r->vk.core);
+    }
+    r->vk.retired_count = kept;
+}
+
+// Swap in a swapchain of the window's current size without idling the
+// device. Everything tied to the old images is parked in `retired` until a
+// frame submitted after this point has finished, by then the old images'
+// last render and present are behind us too.
+static bool recreate_swapchain(render_system_t *r) {
+    if (r->window->width == 0 || r->window->height == 0) return false;
+
+    if (r->vk.retired_count == SWAP_RETIRE_MAX) {
+        // resizing faster than frames retire, wait for the frames in flight
+        re.vkWaitForFences(r->vk.core.logic_dvc, FRAME_FLIGHT,
+                           r->vk.frame_fence, VK_TRUE, UINT64_MAX);
+        release_retired(r, true);
+    }
+
+    render_retired_t *old = &r->vk.retired[r->vk.retired_count++];
+    old->main_framebuff = r->vk.main_framebuff;
+    old->ui_framebuff = r->vk.swap.framebuffer;
+    old->done_sema = r->vk.done_sema;
+    old->free_after = r->vk.submit_serial + 1;
+    WFREE(r->vk.image_fence, sizeof(VkFence) * r->vk.swap.image_count,
+          MEM_RENDER);
+
+    if (!swapchain_reinit(&r->vk.swap, &r->vk.core, r->window,
+                          &old->swap)) {
+        // nothing to draw into, stay empty and try again next frame
+        LOG_ERROR("swapchain recreate failed, retry next frame");
+        swapchain_release(&r->vk.swap, &r->vk.core);
+        r->vk.swap.image_count = 0;
+        r->vk.image_fence = NULL;
+        r->vk.done_sema = NULL;
+        r->vk.main_framebuff = NULL;
+        r->vk.swap.framebuffer = NULL;
+        return false;
+    }
+    set_image_sync(r);
+    set_framebuffer(r);
+
+    r->vk.swap_dirty = false;
+    r->vk.swap_recreates++;
+    LOG_DEBUG("swapchain recreated %ux%u, %u images, %u retired",
+              r->vk.swap.extents.width, r->vk.swap.extents.height,
+              r->vk.swap.image_count, r->vk.retired_count);
+    return true;
+}
+
 /************************************
  * INTERNAL FRAME
  ************************************/
@@ -331,27 +416,28 @@ static bool begin_frame(render_system_t *r, float delta) {
     vk_core_t *core = &r->vk.core;
     uint32_t frames = r->vk.frame_idx;
 
-    /*
-    if (cache_frbuff_width != 0 || cache_frbuff_height != 0) {
-        set_reinit_swapchain(be);
-    }
-    */
-
     /* wait current frame fence (frame-in-flight sync) */
-    re.vkWaitForFences(core->logic_dvc, 1, &r->vk.frame_fence[frames], true,
-                       UINT64_MAX);
-
-    /* acquire next image from the swapchain */
-    VkResult res =
-        re.vkAcquireNextImageKHR(core->logic_dvc, r->vk.swap.handle, UINT64_MAX,
-                                 r->vk.avail_sema[frames], VK_NULL_HANDLE,
-                                 &r->vk.image_idx);
+    wait_slot(r, frames);
+    release_retired(r, false);
+
+    if (r->vk.swap_dirty && !recreate_swapchain(r)) return false;
+
+    /* acquire next image from the swapchain, or the offscreen ring */
+    VkResult res = VK_SUCCESS;
+    if (core->headless) {
+        r->vk.image_idx = (r->vk.image_idx + 1) % r->vk.swap.image_count;
+    } else {
+        res = re.vkAcquireNextImageKHR(core->logic_dvc, r->vk.swap.handle,
+                                       UINT64_MAX, r->vk.avail_sema[frames],
+                                       VK_NULL_HANDLE, &r->vk.image_idx);
+    }
 
     if (res == VK_ERROR_OUT_OF_DATE_KHR) {
-        // set_reinit_swapchain(be);
+        r->vk.swap_dirty = true;
         return false;
     } else if (res == VK_SUBOPTIMAL_KHR) {
-        // set_reinit_swapchain(be);
+        // still presentable, draw this one and recreate before the next
+        r->vk.swap_dirty = true;
     } else if (res != VK_SUCCESS) {
         LOG_ERROR("vkAcquireNextImageKHR failed: %d", res);
         return false;
@@ -390,6 +476,21 @@ static bool begin_frame(render_system_t *r, float delta) {
     return true;
 }
 
+static void update_world(render_system_t *r);
+
+static void headless_present(render_system_t *r) {
+    double now = get_abs_time();
+    if (r->vk.present_count == 0) {
+        r->vk.present_first = now;
+    } else {
+        r->vk.present_worst =
+            MAX(r->vk.present_worst, now - r->vk.present_last);
+    }
+    r->vk.present_last = now;
+    r->vk.present_count++;
+    latency_mark(LATENCY_PRESENT);
+}
+
 static bool end_frame(render_system_t *r, float delta) {
     (void)delta;
     vk_core_t *core = &r->vk.core;
@@ -397,6 +498,13 @@ static bool end_frame(render_system_t *r, float delta) {
 
     cmdbuff_end(&r->vk.cmds[frames]);
 
+    // the recorded draws only reference this frame's UBO slot, so the
+    // camera can still change up to here
+    if (r->latch) {
+        r->latch(r->latch_user);
+        update_world(r);
+    }
+
     /* submit to graphics queue */
     VkPipelineStageFlags wait_stages[] = {
         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
@@ -415,8 +523,27 @@ static bool end_frame(render_system_t *r, float delta) {
     submit_info.signalSemaphoreCount = 1;
     submit_info.pSignalSemaphores = signal_semaphores;
 
-    CHECK_VK(re.vkQueueSubmit(core->graphic_queue, 1, &submit_info,
-                              r->vk.frame_fence[frames]));
+    // nothing was acquired and nothing will be presented
+    if (core->headless) {
+        submit_info.waitSemaphoreCount = 0;
+        submit_info.signalSemaphoreCount = 0;
+    }
+
+    mutex_lock(&g_upload_lock);
+    VkResult submitted = re.vkQueueSubmit(core->graphic_queue, 1, &submit_info,
+                                          r->vk.frame_fence[frames]);
+    mutex_unlock(&g_upload_lock);
+    CHECK_VK(submitted);
+    (void)submitted;
+    r->vk.slot_serial[frames] = ++r->vk.submit_serial;
+    latency_mark(LATENCY_SUBMIT);
+
+    // headless frames are "presented" once they are handed to the queue
+    if (core->headless) {
+        headless_present(r);
+        r->vk.frame_idx = (frames + 1) % FRAME_FLIGHT;
+        return true;
+    }
 
     /* present the frame */
     VkPresentInfoKHR present_info = {};
@@ -427,18 +554,21 @@ static bool end_frame(render_system_t *r, float delta) {
     present_info.pSwapchains = &r->vk.swap.handle;
     present_info.pImageIndices = &images;
 
+    mutex_lock(&g_upload_lock);
     VkResult res = re.vkQueuePresentKHR(core->present_queue, &present_info);
+    mutex_unlock(&g_upload_lock);
+
+    /* advance to next frame-in-flight, the submit went out either way */
+    r->vk.frame_idx = (frames + 1) % FRAME_FLIGHT;
 
     if (res == VK_ERROR_OUT_OF_DATE_KHR || res == VK_SUBOPTIMAL_KHR) {
-        // set_reinit_swapchain(be);
-        return false;
+        r->vk.swap_dirty = true;
+        if (res == VK_ERROR_OUT_OF_DATE_KHR) return false;
     } else if (res != VK_SUCCESS) {
         LOG_ERROR("vkQueuePresentKHR failed: %d", res);
         return false;
     }
-
-    /* advance to next frame-in-flight */
-    r->vk.frame_idx = (frames + 1) % FRAME_FLIGHT;
+    latency_mark(LATENCY_PRESENT);
     return true;
 }
 
@@ -494,7 +624,8 @@ static void draw_world(render_system_t *r, object_bundle_t *obj) {
 }
 
 static void update_world(render_system_t *r) {
-    if (!r->vk.main_material.buffers.mapped) {
+    vk_buffer_t *ubo = &r->vk.main_material.buffers[r->vk.frame_idx];
+    if (!ubo->mapped) {
         LOG_ERROR("UBO frame %u not mapped!", r->vk.frame_idx);
         return;
     }
@@ -502,8 +633,8 @@ static void update_world(render_system_t *r) {
     // update global
     r->vk.main_material.cam_ubo_data.proj = r->camera->main_cam.world_proj;
     r->vk.main_material.cam_ubo_data.view = r->camera->main_cam.world_view;
-    memcpy(r->vk.main_material.buffers.mapped,
-           &r->vk.main_material.cam_ubo_data, sizeof(vk_camera_data_t));
+    memcpy(ubo->mapped, &r->vk.main_material.cam_ubo_data,
+           sizeof(vk_camera_data_t));
 }
 
 /************************************
@@ -531,7 +662,12 @@ static void set_staging_data(render_system_t *r, vk_buffer_t *buffer,
 /************************************************************************
  ************************************************************************/
 
-render_system_t *render_system_init(arena_alloc_t *arena, window_t *window) {
+static const VkPresentModeKHR present_modes[RENDER_PRESENT_MAX] = {
+    VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR,
+    VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR};
+
+render_system_t *render_system_init(arena_alloc_t *arena, window_t *window,
+                                    render_config_t config) {
     if (g_re != NULL) return g_re;
 
     render_system_t *r = arena_alloc(arena, sizeof(render_system_t));
@@ -541,7 +677,18 @@ render_system_t *render_system_init(arena_alloc_t *arena, window_t *window) {
     r->arena = arena;
     r->window = window;
     r->camera = get_camera_system();
+    r->vk.core.headless = window->headless;
+    if (config.present < RENDER_PRESENT_MAX) {
+        r->vk.swap.want_mode = present_modes[config.present];
+    } else {
+        r->vk.swap.want_mode = VK_PRESENT_MODE_FIFO_KHR;
+    }
+    r->vk.swap.want_images = config.image_count;
 
+    if (!mutex_create(&g_upload_lock)) {
+        LOG_FATAL("render upload lock not created");
+        return NULL;
+    }
     if (!core_init(&r->vk.core)) {
         LOG_FATAL("core render not initialized");
         return NULL;
@@ -565,6 +712,11 @@ render_system_t *render_system_init(arena_alloc_t *arena, window_t *window) {
     set_framebuffer(r);
     set_object_buffer(r);
 
+    if (!POOL_CREATE(&r->vk.texture_pool, vk_texture_t, 64, MEM_TEXTURE)) {
+        LOG_FATAL("texture pool not initialized");
+        return NULL;
+    }
+
     material_world_init(&r->vk.core, &r->vk.main_pass, &r->vk.main_material,
                         "shaders/ubo");
 
@@ -597,11 +749,11 @@ render_system_t *render_system_init(arena_alloc_t *arena, window_t *window) {
         const uint32_t idx_count = 6;
         uint32_t indices[6] = {0, 1, 2, 0, 2, 3};
 
-        set_staging_data(r, &r->vk.vertex_buffer, r->vk.core.gfx_pool,
+        set_staging_data(r, &r->vk.vertex_buffer, r->vk.core.upload_pool,
                          r->vk.core.graphic_queue, 0, vert_3d,
                          sizeof(vertex_3d) * vertex_count, RE_BUFFER_STAGING);
 
-        set_staging_data(r, &r->vk.index_buffer, r->vk.core.gfx_pool,
+        set_staging_data(r, &r->vk.index_buffer, r->vk.core.upload_pool,
                          r->vk.core.graphic_queue, 0, indices,
                          sizeof(uint32_t) * idx_count, RE_BUFFER_STAGING);
     }
@@ -617,8 +769,26 @@ void render_system_kill(render_system_t *r) {
 
     re.vkDeviceWaitIdle(r->vk.core.logic_dvc);
 
+    if (r->vk.core.headless && r->vk.present_count > 1) {
+        double span = r->vk.present_last - r->vk.present_first;
+        double avg = span / (double)(r->vk.present_count - 1);
+        LOG_INFO("headless: %lu frames presented, avg %.2fms (%.1f fps), "
+                 "worst %.2fms",
+                 r->vk.present_count, avg * 1000.0, 1.0 / avg,
+                 r->vk.present_worst * 1000.0);
+    }
+
+    if (r->vk.swap_recreates) {
+        LOG_DEBUG("swapchain recreated %u times", r->vk.swap_recreates);
+    }
+    release_retired(r, true);
     material_kill(&r->vk.core, &r->vk.main_material);
 
+    LOG_DEBUG("texture pool: peak %u, %lu allocs, %u slabs",
+              r->vk.texture_pool.peak_count, r->vk.texture_pool.alloc_count,
+              r->vk.texture_pool.slab_count);
+    pool_kill(&r->vk.texture_pool);
+
     unset_object_buffer(r);
     unset_framebuffer(r);
     unset_cmdbuffer(r);
@@ -627,33 +797,46 @@ void render_system_kill(render_system_t *r) {
     renderpass_kill(&r->vk.core, &r->vk.main_pass);
     swapchain_kill(&r->vk.swap, &r->vk.core);
     core_kill(&r->vk.core);
+    mutex_kill(&g_upload_lock);
 
     memset(r, 0, sizeof(render_system_t));
 
     LOG_INFO("render system kill");
 }
 
+uint32_t render_system_wait_frame(render_system_t *r) {
+    uint32_t frames = r->vk.frame_idx;
+    wait_slot(r, frames);
+    return frames;
+}
+
 bool render_system_draw(render_system_t *r, render_bundle_t *bundle) {
-    if (begin_frame(r, bundle->delta)) {
-        update_world(r);
+    if (!begin_frame(r, bundle->delta)) return false;
 
-        if (!begin_pass(r)) {
-            LOG_ERROR("cannot do begin pass");
-            return false;
-        }
+    if (!r->latch) update_world(r);
 
-        for (uint32_t i = 0; i < bundle->obj_count; ++i) {
-            draw_world(r, &bundle->obj[i]);
-        }
+    if (!begin_pass(r)) {
+        LOG_ERROR("cannot do begin pass");
+        return false;
+    }
 
-        if (!end_pass(r)) {
-            LOG_ERROR("cannot do end pass");
-            return false;
-        }
+    for (uint32_t i = 0; i < bundle->obj.count; ++i) {
+        draw_world(r, &bundle->obj.data[i]);
+    }
 
-        end_frame(r, bundle->delta);
+    if (!end_pass(r)) {
+        LOG_ERROR("cannot do end pass");
+        return false;
     }
-    return true;
+
+    return end_frame(r, bundle->delta);
+}
+
+void render_system_set_late_latch(render_system_t *r, render_latch_fn latch,
+                                  void *user) {
+    r->latch = latch;
+    r->latch_user = user;
+    LOG_INFO("camera late latch %s", latch ? "on" : "off");
 }
 
 void render_system_resize(uint32_t width, uint32_t height) {
@@ -665,6 +848,11 @@ void render_system_resize(uint32_t width, uint32_t height) {
             mat4_column_perspective(deg_to_rad(cam.fov), aspect, cam.near,
                                     cam.far);
         g_re->camera->main_cam.dirty = false;
+        g_re->camera->main_cam.revision++;
+
+        // picked up by the next begin_frame, the offscreen ring has a
+        // fixed size
+        if (!g_re->vk.core.headless) g_re->vk.swap_dirty = true;
     }
 }
 
@@ -676,7 +864,8 @@ void render_geo_init(geo_gpu_t *geo, uint32_t v_size, uint32_t v_count,
     geo->vertex_size = v_size;
     uint32_t total_size = v_size * v_count;
 
-    set_staging_data(g_re, &g_re->vk.vertex_buffer, g_re->vk.core.gfx_pool,
+    mutex_lock(&g_upload_lock);
+    set_staging_data(g_re, &g_re->vk.vertex_buffer, g_re->vk.core.upload_pool,
                      g_re->vk.core.graphic_queue, geo->vertex_offset,
                      (void *)vert, total_size, RE_BUFFER_STAGING);
 
@@ -688,18 +877,19 @@ void render_geo_init(geo_gpu_t *geo, uint32_t v_size, uint32_t v_count,
         geo->index_size = i_size;
         total_size = i_size * i_count;
 
-        set_staging_data(g_re, &g_re->vk.index_buffer, g_re->vk.core.gfx_pool,
-                         g_re->vk.core.graphic_queue, geo->index_offset,
-                         (void *)indices, total_size, RE_BUFFER_STAGING);
+        set_staging_data(g_re, &g_re->vk.index_buffer,
+                         g_re->vk.core.upload_pool, g_re->vk.core.graphic_queue,
+                         geo->index_offset, (void *)indices, total_size,
+                         RE_BUFFER_STAGING);
 
         g_re->vk.index_offset += total_size;
     }
+    mutex_unlock(&g_upload_lock);
 }
 
-bool render_tex_init(const uint8_t *pixel, texture_data_t *tex_data) {
-    // TODO: use an allocator
-    tex_data->data_internal =
-        (vk_texture_t *)WALLOC(sizeof(vk_texture_t), MEM_TEXTURE);
+static bool tex_upload(const uint8_t *pixel, texture_data_t *tex_data) {
+    tex_data->data_internal = POOL_ALLOC(&g_re->vk.texture_pool, vk_texture_t);
+    if (!tex_data->data_internal) return false;
 
     vk_texture_t *data = (vk_texture_t *)tex_data->data_internal;
     /*
@@ -730,7 +920,7 @@ bool render_tex_init(const uint8_t *pixel, texture_data_t *tex_data) {
                true, RE_RENDER_TARGET);
 
     vk_cmdbuffer_t temp_buff;
-    VkCommandPool pool = g_re->vk.core.gfx_pool;
+    VkCommandPool pool = g_re->vk.core.upload_pool;
     VkQueue queue = g_re->vk.core.graphic_queue;
     cmdbuff_temp_init(&g_re->vk.core, &temp_buff, pool);
 
@@ -779,7 +969,15 @@ bool render_tex_init(const uint8_t *pixel, texture_data_t *tex_data) {
     return true;
 }
 
+bool render_tex_init(const uint8_t *pixel, texture_data_t *tex_data) {
+    mutex_lock(&g_upload_lock);
+    bool ok = tex_upload(pixel, tex_data);
+    mutex_unlock(&g_upload_lock);
+    return ok;
+}
+
 void render_tex_kill(texture_data_t *tex_data) {
+    mutex_lock(&g_upload_lock);
     re.vkDeviceWaitIdle(g_re->vk.core.logic_dvc);
 
     vk_texture_t *data = (vk_texture_t *)tex_data->data_internal;
@@ -790,7 +988,8 @@ void render_tex_kill(texture_data_t *tex_data) {
         re.vkDestroySampler(g_re->vk.core.logic_dvc, data->sampler,
                             g_re->vk.core.alloc);
         data->sampler = 0;
-        WFREE(tex_data->data_internal, sizeof(vk_texture_t), MEM_TEXTURE);
+        pool_free(&g_re->vk.texture_pool, tex_data->data_internal);
     }
+    mutex_unlock(&g_upload_lock);
     memset(tex_data, 0, sizeof(texture_data_t));
 }
@@ -3,9 +3,21 @@
 
 #include "core/define.h" // IWYU pragma: keep
 #include "core/camera.h"
+#include "core/pool.h"
 #include "frontend_type.h"
 #include "backend_type.h"
 
+// replaced swapchains waiting for the GPU to let go of them
+#define SWAP_RETIRE_MAX (FRAME_FLIGHT + 2)
+
+typedef struct {
+    vk_swapchain_t swap; // old handle, image views and attachments
+    VkFramebuffer *main_framebuff;
+    VkFramebuffer *ui_framebuff;
+    VkSemaphore *done_sema;
+    uint64_t free_after; // submit serial that has to complete first
+} render_retired_t;
+
 typedef struct {
     vk_core_t core;
     vk_swapchain_t swap;
@@ -19,6 +31,7 @@ typedef struct {
     uint32_t index_offset;
 
     vk_material_t main_material;
+    pool_alloc_t texture_pool;
 
     VkSemaphore avail_sema[FRAME_FLIGHT];
     VkSemaphore *done_sema;
@@ -28,8 +41,41 @@ typedef struct {
 
     uint32_t frame_idx;
     uint32_t image_idx;
+
+    // every submit gets a serial, a signaled frame fence means everything
+    // up to that slot's serial is done (one graphics queue, in order)
+    uint64_t submit_serial;
+    uint64_t slot_serial[FRAME_FLIGHT];
+    uint64_t done_serial;
+
+    bool swap_dirty; // recreate before the next acquire
+    uint32_t swap_recreates;
+    render_retired_t retired[SWAP_RETIRE_MAX];
+    uint32_t retired_count;
+
+    // headless present timing
+    uint64_t present_count;
+    double present_first;
+    double present_last;
+    double present_worst; // longest gap between two presents
 } render_t;
 
+typedef enum {
+    RENDER_PRESENT_FIFO = 0,     // vsync, never tears, always available
+    RENDER_PRESENT_FIFO_RELAXED, // vsync, a late frame tears instead of waiting
+    RENDER_PRESENT_MAILBOX,      // vsync, the newest frame replaces queued ones
+    RENDER_PRESENT_IMMEDIATE,    // no vsync, lowest latency, tears
+    RENDER_PRESENT_MAX
+} render_present_t;
+
+typedef struct {
+    render_present_t present; // falls back to FIFO when unsupported
+    uint32_t image_count;     // swapchain images, 0 picks min + 1
+} render_config_t;
+
+// runs right before submit, last chance to move the camera for this frame
+typedef void (*render_latch_fn)(void *user);
+
 typedef struct {
     arena_alloc_t *arena;
     window_t *window;
@@ -37,13 +83,28 @@ typedef struct {
 
     render_t vk;
     render_bundle_t bundle;
+
+    render_latch_fn latch;
+    void *latch_user;
 } render_system_t;
 
-render_system_t *render_system_init(arena_alloc_t *arena, window_t *window);
+render_system_t *render_system_init(arena_alloc_t *arena, window_t *window,
+                                    render_config_t config);
 void render_system_kill(render_system_t *r);
 
+// Blocks until the next frame-in-flight slot is free on the GPU and returns
+// its index, per-frame CPU data tied to that slot may be recycled after this.
+uint32_t render_system_wait_frame(render_system_t *r);
+// False when no frame made it to the screen (e.g. the swapchain went out of
+// date), the caller should draw again.
 bool render_system_draw(render_system_t *r, render_bundle_t *bundle);
 
+// Late latch: the camera UBO is written just before vkQueueSubmit instead
+// of before recording, after `latch` has had a chance to update the camera.
+// NULL turns it off.
+void render_system_set_late_latch(render_system_t *r, render_latch_fn latch,
+                                  void *user);
+
 void render_system_resize(uint32_t width, uint32_t height);
 
 char *vram_status(render_system_t *r);
@@ -3,6 +3,8 @@
 
 #include "core/define.h" // IWYU pragma: keep
 #include "core/math/math_type.h"
+#include "core/container/name.h"
+#include "core/container/darray.h"
 
 typedef struct {
     uint32_t vertex_size;
@@ -27,30 +29,30 @@ typedef struct {
     uint32_t width;
     uint32_t height;
     uint32_t channels;
-    char name[64];
+    name_id_t name;
 
     void *data_internal; // this for pointing to internal vulkan
 } texture_data_t;
 
 typedef struct {
-    // char name[64];
+    name_id_t name;
     vec4 diffuse_color;
     texture_data_t *tex;
     bool has_texture;
 } material_data_t;
 
-#define MAX_GEO 10
-
 typedef struct {
     geo_gpu_t *geo;
     mat4 model;
     material_data_t material;
 } object_bundle_t;
 
+DARRAY_DEFINE(object_list, object_bundle_t)
+
 typedef struct {
-    object_bundle_t obj[MAX_GEO];
-    uint32_t obj_count;
+    object_list_t obj;
     float delta;
+    uint32_t revision; // bump after editing `obj`, on-demand drawing checks it
 } render_bundle_t;
 
 #endif // FRONTEND_TYPE_H
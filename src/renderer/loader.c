@@ -143,6 +143,7 @@ bool vk_load_instance(VkInstance inst) {
                   PFN_vkGetPhysicalDeviceSurfacePresentModesKHR);
 
     // ================= DEBUG UTILITIES FUNCTIONS ====================
+#ifdef DEBUG
     re.vkCreateDebugUtilsMessengerEXT =
         INST_PROC(inst, "vkCreateDebugUtilsMessengerEXT",
                   PFN_vkCreateDebugUtilsMessengerEXT);
@@ -150,6 +151,7 @@ bool vk_load_instance(VkInstance inst) {
     re.vkDestroyDebugUtilsMessengerEXT =
         INST_PROC(inst, "vkDestroyDebugUtilsMessengerEXT",
                   PFN_vkDestroyDebugUtilsMessengerEXT);
+#endif
 
     s_dpa = re.vkGetDeviceProcAddr;
     return (re.vkCreateDevice && re.vkEnumeratePhysicalDevices);